@@ -25,11 +25,13 @@
 #include "../Savegame/SavedGame.h"
 #include "TileEngine.h"
 #include "BattlescapeState.h"
+#include "BattleSimulation.h"
 #include "../Savegame/Tile.h"
 #include "Pathfinding.h"
 #include "../Engine/RNG.h"
 #include "../Engine/Logger.h"
 #include "../Engine/Game.h"
+#include "../Engine/ThreadPool.h"
 #include "../Mod/Armor.h"
 #include "../Mod/Mod.h"
 #include "../Mod/RuleItem.h"
@@ -38,6 +40,40 @@
 namespace OpenXcom
 {
 
+namespace
+{
+
+/// Minimal number of candidates worth sending to worker threads.
+constexpr size_t MinParallelCandidates = 16;
+
+/**
+ * Evaluates candidates on the AI worker threads, or on the calling thread if there are none.
+ * The game thread waits for the result, so the battle is not modified during evaluation;
+ * `f` must only read the battle state and store its result by index,
+ * any decision (and RNG use) has to happen afterwards in candidate order.
+ * @param save Battle game.
+ * @param count Number of candidates.
+ * @param f Function called for each candidate index.
+ */
+template<typename F>
+void evaluateCandidates(SavedBattleGame *save, size_t count, F &&f)
+{
+	ThreadPool *pool = save->getBattleGame() ? save->getBattleGame()->getThreadPool() : nullptr;
+	if (pool && count >= MinParallelCandidates)
+	{
+		pool->parallelFor(count, f);
+	}
+	else
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			f(i);
+		}
+	}
+}
+
+}
+
 
 /**
  * Sets up a BattleAIState.
@@ -60,7 +96,8 @@ AIModule::AIModule(SavedBattleGame *save, BattleUnit *unit, Node *node) :
 	_patrolAction = BattleAction();
 	_psiAction = BattleAction();
 	_targetFaction = FACTION_PLAYER;
-	if (_unit->getOriginalFaction() == FACTION_NEUTRAL)
+	// when the battle simulation plays for the player, their units hunt aliens too
+	if (_unit->getOriginalFaction() == FACTION_NEUTRAL || (BattleSimulation::isRunning() && _unit->getFaction() == FACTION_PLAYER))
 	{
 		_targetFaction = FACTION_HOSTILE;
 	}
@@ -1825,27 +1862,37 @@ bool AIModule::findFirePoint()
 		return false;
 	std::vector<Position> randomTileSearch = _save->getTileSearch();
 	RNG::shuffle(randomTileSearch);
-	Position target;
 	const int BASE_SYSTEMATIC_SUCCESS = 100;
 	const int FAST_PASS_THRESHOLD = 125;
 	bool waitIfOutsideWeaponRange = _unit->getGeoscapeSoldier() ? false : _unit->getUnitRules()->waitIfOutsideWeaponRange();
 	bool extendedFireModeChoiceEnabled = _save->getBattleGame()->getMod()->getAIExtendedFireModeChoice();
 	int bestScore = 0;
 	_attackAction.type = BA_RETHINK;
-	for (std::vector<Position>::const_iterator i = randomTileSearch.begin(); i != randomTileSearch.end(); ++i)
+
+	// line of fire from every candidate is checked first (on worker threads if possible),
+	// the search itself stays in the shuffled order so the result does not depend on threads.
+	std::vector<Uint8> canTarget(randomTileSearch.size(), 0);
+	evaluateCandidates(_save, randomTileSearch.size(), [&](size_t n)
 	{
-		Position pos = _unit->getPosition() + *i;
+		Position pos = _unit->getPosition() + randomTileSearch[n];
 		Tile *tile = _save->getTile(pos);
 		if (tile == 0  ||
 			std::find(_reachableWithAttack.begin(), _reachableWithAttack.end(), _save->getTileIndex(pos))  == _reachableWithAttack.end())
-			continue;
-		int score = 0;
+			return;
 		// i should really make a function for this
 		Position origin = pos.toVoxel() +
 			// 4 because -2 is eyes and 2 below that is the rifle (or at least that's my understanding)
 			Position(8,8, _unit->getHeight() + _unit->getFloatHeight() - tile->getTerrainLevel() - 4);
+		Position scan;
+		canTarget[n] = _save->getTileEngine()->canTargetUnit(&origin, _aggroTarget->getTile(), &scan, _unit, false);
+	});
 
-		if (_save->getTileEngine()->canTargetUnit(&origin, _aggroTarget->getTile(), &target, _unit, false))
+	for (size_t n = 0; n < randomTileSearch.size(); ++n)
+	{
+		Position pos = _unit->getPosition() + randomTileSearch[n];
+		int score = 0;
+
+		if (canTarget[n])
 		{
 			_save->getPathfinding()->calculate(_unit, pos, BAM_NORMAL);
 			// can move here
@@ -2786,25 +2833,30 @@ bool AIModule::getNodeOfBestEfficacy(BattleAction *action, int radius)
 {
 	int bestScore = 2;
 	Position originVoxel = _save->getTileEngine()->getSightOriginVoxel(_unit);
-	Position targetVoxel;
-	for (std::vector<Node*>::const_iterator i = _save->getNodes()->begin(); i != _save->getNodes()->end(); ++i)
+	const std::vector<Node*> &nodes = *_save->getNodes();
+
+	// every node is scored independently (on worker threads if possible), best one is picked in node order
+	std::vector<int> points(nodes.size(), INT_MIN);
+	evaluateCandidates(_save, nodes.size(), [&](size_t n)
 	{
-		if ((*i)->isDummy())
+		Node *node = nodes[n];
+		if (node->isDummy())
 		{
-			continue;
+			return;
 		}
-		int dist = Position::distance2d((*i)->getPosition(), _unit->getPosition());
+		Position targetVoxel;
+		int dist = Position::distance2d(node->getPosition(), _unit->getPosition());
 		if (dist <= 20 && dist > radius &&
-			_save->getTileEngine()->canTargetTile(&originVoxel, _save->getTile((*i)->getPosition()), O_FLOOR, &targetVoxel, _unit, false))
+			_save->getTileEngine()->canTargetTile(&originVoxel, _save->getTile(node->getPosition()), O_FLOOR, &targetVoxel, _unit, false))
 		{
 			int nodePoints = 0;
 			for (std::vector<BattleUnit*>::const_iterator j = _save->getUnits()->begin(); j != _save->getUnits()->end(); ++j)
 			{
-				dist = Position::distance2d((*i)->getPosition(), (*j)->getPosition());
+				dist = Position::distance2d(node->getPosition(), (*j)->getPosition());
 				if (!(*j)->isOut() && dist < radius)
 				{
 					Position targetOriginVoxel = _save->getTileEngine()->getSightOriginVoxel(*j);
-					if (_save->getTileEngine()->canTargetTile(&targetOriginVoxel, _save->getTile((*i)->getPosition()), O_FLOOR, &targetVoxel, *j, false))
+					if (_save->getTileEngine()->canTargetTile(&targetOriginVoxel, _save->getTile(node->getPosition()), O_FLOOR, &targetVoxel, *j, false))
 					{
 						if ((_unit->getFaction() == FACTION_HOSTILE && (*j)->getFaction() != FACTION_HOSTILE) ||
 							(_unit->getFaction() == FACTION_NEUTRAL && (*j)->getFaction() == FACTION_HOSTILE))
@@ -2821,11 +2873,16 @@ bool AIModule::getNodeOfBestEfficacy(BattleAction *action, int radius)
 					}
 				}
 			}
-			if (nodePoints > bestScore)
-			{
-				bestScore = nodePoints;
-				action->target = (*i)->getPosition();
-			}
+			points[n] = nodePoints;
+		}
+	});
+
+	for (size_t n = 0; n < nodes.size(); ++n)
+	{
+		if (points[n] > bestScore)
+		{
+			bestScore = points[n];
+			action->target = nodes[n]->getPosition();
 		}
 	}
 	return bestScore > 2;
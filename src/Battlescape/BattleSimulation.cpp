@@ -0,0 +1,190 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BattleSimulation.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <yaml-cpp/yaml.h>
+#include "BattlescapeState.h"
+#include "../Engine/Action.h"
+#include "../Engine/Exception.h"
+#include "../Engine/Game.h"
+#include "../Engine/Logger.h"
+#include "../Engine/Options.h"
+#include "../Engine/Screen.h"
+#include "../Geoscape/GeoscapeState.h"
+#include "../Savegame/SavedGame.h"
+#include "../Savegame/SavedBattleGame.h"
+#include "../Savegame/BattleUnit.h"
+
+namespace OpenXcom
+{
+
+bool BattleSimulation::_running = false;
+double BattleSimulation::_phaseTime[SP_MAX] = { };
+Uint64 BattleSimulation::_phaseCalls[SP_MAX] = { };
+int BattleSimulation::_phaseDepth[SP_MAX] = { };
+int BattleSimulation::_turns = 0;
+int BattleSimulation::_startTurn = 0;
+int BattleSimulation::_sideTurns = 0;
+std::chrono::steady_clock::time_point BattleSimulation::_startTime;
+
+namespace
+{
+
+const char *phaseNames[SP_MAX] = { "pathfinding", "FOV", "lighting", "AI", "reaction fire" };
+
+}
+
+/**
+ * Loads a saved game with a battle in progress and opens the battlescape,
+ * from then on all sides are played by AI.
+ * @param game Pointer to the core game.
+ * @param filename Save file name, in the user folder.
+ * @param turns Number of full turns to simulate.
+ */
+void BattleSimulation::start(Game *game, const std::string &filename, int turns)
+{
+	Log(LOG_INFO) << "Simulating " << turns << " turns of battle " << filename;
+	SavedGame *s = new SavedGame();
+	try
+	{
+		s->load(filename, game->getMod(), game->getLanguage());
+	}
+	catch (Exception &e)
+	{
+		Log(LOG_ERROR) << "Failed to load " << filename << ": " << e.what();
+		delete s;
+		game->quit();
+		return;
+	}
+	catch (YAML::Exception &e)
+	{
+		Log(LOG_ERROR) << "Failed to load " << filename << ": " << e.what();
+		delete s;
+		game->quit();
+		return;
+	}
+	if (s->getSavedBattle() == 0)
+	{
+		Log(LOG_ERROR) << filename << " is not a battlescape save";
+		delete s;
+		game->quit();
+		return;
+	}
+
+	game->setSavedGame(s);
+	game->setState(new GeoscapeState);
+	s->setGamePtr(game);
+	s->getSavedBattle()->loadMapResources(game->getMod());
+	Options::baseXResolution = Options::baseXBattlescape;
+	Options::baseYResolution = Options::baseYBattlescape;
+	game->getScreen()->resetDisplay(false);
+	BattlescapeState *bs = new BattlescapeState;
+	game->pushState(bs);
+	s->getSavedBattle()->setBattleState(bs);
+
+	for (int i = 0; i < SP_MAX; ++i)
+	{
+		_phaseTime[i] = 0;
+		_phaseCalls[i] = 0;
+	}
+	_turns = turns;
+	_startTurn = s->getSavedBattle()->getTurn();
+	_sideTurns = 0;
+	_startTime = std::chrono::steady_clock::now();
+	_running = true;
+}
+
+/**
+ * Called at the end of every side's turn, stops the simulation
+ * when the requested number of full turns was played.
+ * @param game Pointer to the core game.
+ * @param save Pointer to the battle.
+ * @return True if the simulation is over.
+ */
+bool BattleSimulation::turnEnded(Game *game, SavedBattleGame *save)
+{
+	_sideTurns += 1;
+	if (save->getSide() == FACTION_PLAYER && save->getTurn() - _startTurn >= _turns)
+	{
+		finish(game, "finished");
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Called instead of the debriefing, the battle can't continue.
+ * @param game Pointer to the core game.
+ */
+void BattleSimulation::battleEnded(Game *game)
+{
+	finish(game, "ended early, the battle is over");
+}
+
+/**
+ * Presses OK on whatever popup, infobox or next turn screen
+ * is on top of the battlescape, as there's no player to do it.
+ * @param state Pointer to the active state.
+ */
+void BattleSimulation::dismissMessages(State *state)
+{
+	if (dynamic_cast<BattlescapeState*>(state) != 0)
+	{
+		return;
+	}
+	SDL_Event ev = {};
+	ev.type = SDL_KEYDOWN;
+	ev.key.state = SDL_PRESSED;
+	ev.key.keysym.sym = Options::keyOk;
+	Action action = Action(&ev, 1.0, 1.0, 0, 0);
+	state->handle(&action);
+}
+
+/**
+ * Prints time spent in each phase and quits the game.
+ * Phases overlap, AI time includes pathfinding and FOV updates done by the AI.
+ * @param game Pointer to the core game.
+ * @param reason Why the simulation ended.
+ */
+void BattleSimulation::finish(Game *game, const std::string &reason)
+{
+	double total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _startTime).count();
+	int turns = game->getSavedGame()->getSavedBattle()->getTurn() - _startTurn;
+
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(1);
+	ss << "Battle simulation " << reason << ": " << turns << " turns (" << _sideTurns << " side turns) in " << total << " ms" << std::endl;
+	ss << std::left << std::setw(16) << "phase" << std::right << std::setw(12) << "ms" << std::setw(10) << "calls" << std::setw(8) << "%" << std::setw(12) << "ms/turn" << std::endl;
+	for (int i = 0; i < SP_MAX; ++i)
+	{
+		ss << std::left << std::setw(16) << phaseNames[i] << std::right << std::setw(12) << _phaseTime[i] << std::setw(10) << _phaseCalls[i]
+			<< std::setw(8) << (total > 0 ? _phaseTime[i] * 100 / total : 0) << std::setw(12) << _phaseTime[i] / std::max(turns, 1) << std::endl;
+	}
+
+	std::cout << ss.str();
+	Log(LOG_INFO) << ss.str();
+
+	_running = false;
+	game->quit();
+}
+
+}
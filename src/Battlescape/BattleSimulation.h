@@ -0,0 +1,93 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <string>
+#include <SDL_types.h>
+
+namespace OpenXcom
+{
+
+class Game;
+class SavedBattleGame;
+class State;
+
+/// Parts of battlescape processing timed by the battle simulation.
+enum SimulationPhase { SP_PATHFINDING, SP_FOV, SP_LIGHTING, SP_AI, SP_REACTION_FIRE, SP_MAX };
+
+/**
+ * Runs a saved battle without player input or rendering, with AI on all sides,
+ * and reports how much time was spent in each part of battlescape processing.
+ * Used to profile mod content from the command line (-simulateBattle FILE -simulateTurns N).
+ */
+class BattleSimulation
+{
+private:
+	static bool _running;
+	static double _phaseTime[SP_MAX];
+	static Uint64 _phaseCalls[SP_MAX];
+	static int _phaseDepth[SP_MAX];
+	static int _turns, _startTurn, _sideTurns;
+	static std::chrono::steady_clock::time_point _startTime;
+
+	/// Prints the timings and quits the game.
+	static void finish(Game *game, const std::string &reason);
+public:
+	/**
+	 * Measures time spent in its scope, when the simulation is running.
+	 * Nested scopes of the same phase are counted once.
+	 */
+	class PhaseTimer
+	{
+		SimulationPhase _phase;
+		bool _active;
+		std::chrono::steady_clock::time_point _start;
+	public:
+		/// Starts timing a phase.
+		PhaseTimer(SimulationPhase phase) : _phase(phase), _active(_running)
+		{
+			if (_active && _phaseDepth[_phase]++ == 0)
+			{
+				_start = std::chrono::steady_clock::now();
+			}
+		}
+		/// Adds time spent in the scope to the phase.
+		~PhaseTimer()
+		{
+			if (_active && --_phaseDepth[_phase] == 0)
+			{
+				_phaseTime[_phase] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+				_phaseCalls[_phase] += 1;
+			}
+		}
+	};
+
+	/// Loads a saved battle and starts simulating it.
+	static void start(Game *game, const std::string &filename, int turns);
+	/// Is a battle simulation running?
+	static bool isRunning() { return _running; }
+	/// Counts finished turns and stops the simulation after the requested number.
+	static bool turnEnded(Game *game, SavedBattleGame *save);
+	/// Stops the simulation when the battle is over.
+	static void battleEnded(Game *game);
+	/// Closes any message shown on top of the battlescape.
+	static void dismissMessages(State *state);
+};
+
+}
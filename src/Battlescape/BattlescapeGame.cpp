@@ -22,6 +22,7 @@
 #include "Map.h"
 #include "Camera.h"
 #include "NextTurnState.h"
+#include "BattleSimulation.h"
 #include "BattleState.h"
 #include "UnitTurnBState.h"
 #include "UnitWalkBState.h"
@@ -55,6 +56,7 @@
 #include "../Mod/RuleTerrain.h"
 #include "../Mod/Armor.h"
 #include "../Engine/Options.h"
+#include "../Engine/ThreadPool.h"
 #include "../Engine/RNG.h"
 #include "../FTA/MasterMind.h"
 #include "InfoboxState.h"
@@ -198,6 +200,16 @@ BattlescapeGame::BattlescapeGame(SavedBattleGame *save, BattlescapeState *parent
 
 	_debugPlay = false;
 
+	if (Options::battleThreads != 0)
+	{
+		// the game thread takes part in the work too
+		size_t threads = ThreadPool::getThreadCount(Options::battleThreads);
+		if (threads > 1)
+		{
+			_workerThreads = std::make_unique<ThreadPool>(threads - 1);
+		}
+	}
+
 	checkForCasualties(nullptr, BattleActionAttack{ }, true);
 	cancelCurrentAction();
 }
@@ -229,8 +241,8 @@ void BattlescapeGame::think()
 			_save->setUnitsFalling(false);
 			return;
 		}
-		// it's a non player side (ALIENS or CIVILIANS)
-		if (_save->getSide() != FACTION_PLAYER)
+		// it's a non player side (ALIENS or CIVILIANS), or the battle simulation plays for the player
+		if (_save->getSide() != FACTION_PLAYER || (BattleSimulation::isRunning() && _playerPanicHandled))
 		{
 			_save->resetUnitHitStates();
 			if (!_debugPlay)
@@ -288,6 +300,7 @@ void BattlescapeGame::init()
  */
 void BattlescapeGame::handleAI(BattleUnit *unit)
 {
+	BattleSimulation::PhaseTimer timer(SP_AI);
 	std::ostringstream ss;
 
 	if (unit->getTimeUnits() <= 5)
@@ -699,6 +712,13 @@ void BattlescapeGame::endTurn()
 
 	bool battleComplete = (!killingAllAliensIsNotEnough && tally.liveAliens == 0 && !toDoScripts) || tally.liveSoldiers == 0;
 
+	if (BattleSimulation::isRunning() && _endTurnRequested && !battleComplete
+		&& BattleSimulation::turnEnded(_parentState->getGame(), _save))
+	{
+		_endTurnRequested = false;
+		return;
+	}
+
 	if ((_save->getSide() != FACTION_NEUTRAL || battleComplete)
 		&& _endTurnRequested)
 	{
@@ -22,6 +22,7 @@
 #include <string>
 #include <list>
 #include <vector>
+#include <memory>
 
 namespace OpenXcom
 {
@@ -41,6 +42,7 @@ class SoldierDiary;
 class RuleSkill;
 class BattleScript;
 class RuleTerrain;
+class ThreadPool;
 
 enum BattleActionMove : char { BAM_NORMAL = 0, BAM_RUN = 1, BAM_STRAFE = 2, BAM_SNEAK = 3, BAM_MISSILE = 4 };
 
@@ -179,6 +181,8 @@ private:
 	SingleRun _endTurnProcessed;
 	SingleRun _triggerProcessed;
 
+	std::unique_ptr<ThreadPool> _workerThreads;
+
 	/// Ends the turn.
 	void endTurn();
 	/// Picks the first soldier that is panicking.
@@ -283,6 +287,8 @@ public:
 	Pathfinding *getPathfinding();
 	/// Gets the mod.
 	Mod *getMod();
+	/// Gets worker threads used by AI to evaluate candidate positions and by explosions to trace rays.
+	ThreadPool *getThreadPool() { return _workerThreads.get(); }
 	/// Returns whether panic has been handled.
 	bool getPanicHandled() const { return _playerPanicHandled; }
 	/// Tries to find an item and pick it up if possible.
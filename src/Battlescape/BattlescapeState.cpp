@@ -32,6 +32,7 @@
 #include "AlienInventoryState.h"
 #include "Pathfinding.h"
 #include "BattlescapeGame.h"
+#include "BattleSimulation.h"
 #include "WarningMessage.h"
 #include "InfoboxState.h"
 #include "TurnDiaryState.h"
@@ -832,7 +833,7 @@ void BattlescapeState::init()
 	_txtTooltip->setText("");
 	_btnReserveKneel->toggle(_save->getKneelReserved());
 	_battleGame->setKneelReserved(_save->getKneelReserved());
-	if (_autosave > 0 && !_save->isPreview())
+	if (_autosave > 0 && !_save->isPreview() && !BattleSimulation::isRunning())
 	{
 		int currentTurn = _autosave;
 		_autosave = 0;
@@ -2516,6 +2517,23 @@ void BattlescapeState::debug(const std::string &message)
 	}
 }
 
+/**
+ * Runs all battlescape benchmarks on the current battle.
+ * Pathfinding is only measured when a playable unit is selected.
+ * Results are written to the log.
+ */
+void BattlescapeState::runBenchmarks()
+{
+	if (playableUnitSelected())
+	{
+		_save->getPathfinding()->benchmark(_save->getSelectedUnit(), 10);
+	}
+	_save->getTileEngine()->benchmarkLighting(10);
+	_map->benchmarkDraw(50, 1920, 1080);
+	_map->benchmarkUnitSprites(100);
+	debug("Benchmarks done, see log");
+}
+
 /**
 * Shows a bug hunt message in the topleft corner.
 */
@@ -2812,6 +2830,11 @@ inline void BattlescapeState::handle(Action *action)
 						debug("Resetting tile visibility");
 						_save->resetTiles();
 					}
+					// "ctrl-p" - run benchmarks
+					else if (_save->getDebugMode() && key == SDLK_p && ctrlPressed)
+					{
+						runBenchmarks();
+					}
 					else if (_save->getDebugMode() && (key == SDLK_k || key == SDLK_j) && ctrlPressed)
 					{
 						bool stunOnly = (key == SDLK_j);
@@ -3236,6 +3259,12 @@ void BattlescapeState::popup(State *state)
  */
 void BattlescapeState::finishBattle(bool abort, int inExitArea)
 {
+	if (BattleSimulation::isRunning())
+	{
+		BattleSimulation::battleEnded(_game);
+		return;
+	}
+
 	bool isPreview = _save->isPreview();
 
 	while (!_game->isState(this))
@@ -228,6 +228,8 @@ public:
 	Map *getMap() const;
 	/// Show debug message.
 	void debug(const std::string &message);
+	/// Run debug benchmarks.
+	void runBenchmarks();
 	/// Show bug hunt message.
 	void bugHuntMessage();
 	/// Show warning message.
@@ -19,6 +19,7 @@
 #include "Map.h"
 #include "Camera.h"
 #include "UnitSprite.h"
+#include "SpriteVariantCache.h"
 #include "ItemSprite.h"
 #include "Pathfinding.h"
 #include "TileEngine.h"
@@ -36,6 +37,7 @@
 #include "../Engine/Screen.h"
 #include "../Engine/ShaderDraw.h"
 #include "../Engine/ShaderMove.h"
+#include "../Engine/ThreadPool.h"
 #include "../Savegame/SavedBattleGame.h"
 #include "../Savegame/Tile.h"
 #include "../Savegame/BattleUnit.h"
@@ -51,7 +53,9 @@
 #include "../Savegame/SavedGame.h"
 #include "../Interface/NumberText.h"
 #include "../Interface/Text.h"
+#include "../Engine/Benchmark.h"
 #include "../fmath.h"
+#include <sstream>
 
 
 /*
@@ -108,7 +112,8 @@ Map::Map(Game *game, int width, int height, int x, int y, int visibleMapHeight)
 	_game(game), _arrow(0), _missionPointer(0), _sensorPointer(0), _anyIndicator(false), _isAltPressed(false),
 	_selectorX(0), _selectorY(0), _mouseX(0), _mouseY(0), _cursorType(CT_NORMAL), _cursorSize(1), _animFrame(0),
 	_projectile(0), _followProjectile(true), _projectileInFOV(false), _explosionInFOV(false), _launch(false), _visibleMapHeight(visibleMapHeight),
-	_unitDying(false), _smoothingEngaged(false), _flashScreen(false), _bgColor(15), _projectileSet(0), _showObstacles(false)
+	_unitDying(false), _smoothingEngaged(false), _flashScreen(false), _bgColor(15), _projectileSet(0), _showObstacles(false),
+	_dirtyRectsOnly(false), _idleFrames(0)
 {
 	_iconHeight = _game->getMod()->getInterface("battlescape")->getElement("icons")->h;
 	_iconWidth = _game->getMod()->getInterface("battlescape")->getElement("icons")->w;
@@ -146,6 +151,16 @@ Map::Map(Game *game, int width, int height, int x, int y, int visibleMapHeight)
 	_obstacleTimer = new Timer(2500);
 	_obstacleTimer->stop();
 	_obstacleTimer->onTimer((SurfaceHandler)&Map::disableObstacles);
+	_spriteCache = new SpriteVariantCache(SPRITE_CACHE_SIZE);
+	if (Options::battleDrawThreads != 0)
+	{
+		// the game thread draws a band too
+		size_t drawThreads = ThreadPool::getThreadCount(Options::battleDrawThreads);
+		if (drawThreads > 1)
+		{
+			_drawThreads = std::make_unique<ThreadPool>(drawThreads - 1);
+		}
+	}
 
 	_txtAccuracy = new Text(44, 18, 0, 0);
 	_txtAccuracy->setSmall();
@@ -226,6 +241,7 @@ Map::~Map()
 	delete _message;
 	delete _camera;
 	delete _txtAccuracy;
+	delete _spriteCache;
 }
 
 /**
@@ -331,20 +347,18 @@ void Map::draw()
 	{
 		return;
 	}
-
-	// normally we'd call for a Surface::draw();
-	// but we don't want to clear the background with colour 0, which is transparent (aka black)
-	// we use colour 15 because that actually corresponds to the colour we DO want in all variations of the xcom and tftd palettes.
-	// Note: un-hardcoded the color from 15 to ruleset value, default 15
 	_redraw = false;
-	ShaderDrawFunc(
-		[](Uint8& dest, Uint8 color)
-		{
-			dest = color;
-		},
-		ShaderSurface(this),
-		ShaderScalar<Uint8>(Palette::blockOffset(0) + _bgColor)
-	);
+	_isAltPressed = _game->isAltPressed(true);
+
+	bool dirtyRectsOnly = _dirtyRectsOnly;
+	_dirtyRectsOnly = false;
+	std::vector<intptr_t> viewState;
+	getViewState(viewState);
+	if (viewState != _viewState)
+	{
+		dirtyRectsOnly = false;
+		_viewState = std::move(viewState);
+	}
 
 	Tile *t;
 
@@ -371,9 +385,45 @@ void Map::draw()
 		}
 	}
 
-	if ((_save->getSelectedUnit() && _save->getSelectedUnit()->getVisible()) || _unitDying || _save->getSide() == FACTION_PLAYER || _save->getDebugMode() || _projectileInFOV || _explosionInFOV)
+	bool drawMap = (_save->getSelectedUnit() && _save->getSelectedUnit()->getVisible()) || _unitDying || _save->getSide() == FACTION_PLAYER || _save->getDebugMode() || _projectileInFOV || _explosionInFOV;
+
+	// only the parts that changed while waiting for the player, anything else going on redraws the whole map
+	if (dirtyRectsOnly && drawMap && !_projectile && _explosions.empty() && !_showObstacles && !_isAltPressed && !_save->getBattleGame()->isBusy())
+	{
+		int area = 0;
+		for (const auto& r : _dirtyRects)
+		{
+			area += r.w * r.h;
+		}
+		if (area * 100 < getWidth() * getHeight() * MAX_DIRTY_AREA_PERCENT)
+		{
+			drawDirtyRects();
+			return;
+		}
+	}
+	_dirtyRects.clear();
+
+	if (drawMap && drawBands())
+	{
+		return;
+	}
+
+	// normally we'd call for a Surface::draw();
+	// but we don't want to clear the background with colour 0, which is transparent (aka black)
+	// we use colour 15 because that actually corresponds to the colour we DO want in all variations of the xcom and tftd palettes.
+	// Note: un-hardcoded the color from 15 to ruleset value, default 15
+	ShaderDrawFunc(
+		[](Uint8& dest, Uint8 color)
+		{
+			dest = color;
+		},
+		ShaderSurface(this),
+		ShaderScalar<Uint8>(Palette::blockOffset(0) + _bgColor)
+	);
+
+	if (drawMap)
 	{
-		drawTerrain(this);
+		drawTerrain(this, _camera);
 	}
 	else
 	{
@@ -381,6 +431,245 @@ void Map::draw()
 	}
 }
 
+/**
+ * Draws a part of the map into a scratch surface with a copy of the camera
+ * shifted to its corner, so all tiles overlapping it are drawn in the usual order,
+ * then copies it into the map. Tiles are culled by the surface size, so a margin
+ * around the part is drawn too, to not depend on that at its edges.
+ * Parts that don't overlap can be drawn on different threads at once.
+ * @param rect Part of the map to draw.
+ * @param area Scratch surface, larger than the part by the margin on every side.
+ */
+void Map::drawArea(const SDL_Rect &rect, Surface *area)
+{
+	const int margin = (area->getWidth() - rect.w) / 2;
+	const Position cameraPos = _camera->getMapOffset();
+
+	ShaderDrawFunc(
+		[](Uint8& dest, Uint8 color)
+		{
+			dest = color;
+		},
+		ShaderSurface(area),
+		ShaderScalar<Uint8>(Palette::blockOffset(0) + _bgColor)
+	);
+
+	Camera camera = *_camera;
+	camera.setMapOffset(Position(cameraPos.x - rect.x + margin, cameraPos.y - rect.y + margin, cameraPos.z));
+	drawTerrain(area, &camera);
+
+	auto target = ShaderSurface(this);
+	target.setDomain(GraphSubset(std::make_pair(rect.x, rect.x + rect.w), std::make_pair(rect.y, rect.y + rect.h)));
+	ShaderDrawFunc(
+		[](Uint8& dest, const Uint8& src)
+		{
+			dest = src;
+		},
+		target,
+		ShaderMove<const Uint8>(area, rect.x - margin, rect.y - margin)
+	);
+}
+
+/**
+ * Redraws only the dirty rectangles of the map.
+ */
+void Map::drawDirtyRects()
+{
+	const Uint8 debugColor = Palette::blockOffset(1 + _animFrame % 8) + 1;
+
+	lock();
+	for (const auto& r : _dirtyRects)
+	{
+		Surface area(r.w + 2 * _spriteHeight, r.h + 2 * _spriteHeight);
+		drawArea(r, &area);
+	}
+	unlock();
+
+	if (Options::debugDirtyRects)
+	{
+		for (const auto& r : _dirtyRects)
+		{
+			drawRect(r.x, r.y, r.w, 1, debugColor);
+			drawRect(r.x, r.y + r.h - 1, r.w, 1, debugColor);
+			drawRect(r.x, r.y, 1, r.h, debugColor);
+			drawRect(r.x + r.w - 1, r.y, 1, r.h, debugColor);
+		}
+	}
+	_dirtyRects.clear();
+}
+
+/**
+ * Draws the whole map split in horizontal bands, one per draw thread.
+ * Anything that changes the map state while drawing, or that
+ * can't be done on a worker thread, keeps drawing on the game thread.
+ * @return True if the map was drawn.
+ */
+bool Map::drawBands()
+{
+	if (!_drawThreads || _projectile || !_explosions.empty() || !_waypoints.empty() || Options::getProfileScripts())
+	{
+		return false;
+	}
+	// waypoint and path preview numbers create surfaces
+	if (_save->getPathfinding()->isPathPreviewed() && (_previewSettingTu || _previewSettingEnergy))
+	{
+		return false;
+	}
+	// the accuracy text and its caches are shared, psi and waypoint cursors draw it even without the accuracy option
+	if (_cursorType == CT_PSI || _cursorType == CT_WAYPOINT || (_cursorType == CT_AIM && Options::battleUFOExtenderAccuracy))
+	{
+		return false;
+	}
+	const int bands = std::min((int)_drawThreads->size() + 1, getHeight() / (_spriteHeight * MIN_BAND_HEIGHT));
+	if (bands < 2)
+	{
+		return false;
+	}
+
+	// sprites can be loaded on first use, that has to happen on this thread
+	Mod *mod = _game->getMod();
+	for (const char *name : { "CURSOR.PCK", "SMOKE.PCK", "Pathfinding", "HANDOB.PCK", "DETBLOB.DAT", "FLOOROB.PCK" })
+	{
+		mod->getSurfaceSet(name);
+	}
+	mod->getSurfaceSet("BREATH-1.PCK", false);
+	mod->getSurface("UnitWarnedIndicator", false);
+	for (auto unit : *_save->getUnits())
+	{
+		mod->getSurfaceSet(unit->getArmor()->getSpriteSheet());
+	}
+
+	std::vector<SDL_Rect> rects(bands);
+	std::vector<Surface> areas;
+	areas.reserve(bands);
+	for (int i = 0; i < bands; ++i)
+	{
+		SDL_Rect &r = rects[i];
+		r.x = 0;
+		r.y = getHeight() * i / bands;
+		r.w = getWidth();
+		r.h = getHeight() * (i + 1) / bands - r.y;
+		areas.emplace_back(r.w + 2 * _spriteHeight, r.h + 2 * _spriteHeight);
+	}
+
+	lock();
+	_drawThreads->parallelFor(bands, [&](size_t i)
+	{
+		drawArea(rects[i], &areas[i]);
+	});
+	unlock();
+	return true;
+}
+
+/**
+ * Measures how long it takes to draw the whole map, once on the game thread
+ * and once split in bands on all cores. Draws with the current cursor and state,
+ * so anything that keeps the map on the game thread applies to both.
+ * The viewport is resized for the benchmark, so results don't depend on the window size.
+ * Results are written to the log.
+ * @param iterations How many frames are drawn in every mode.
+ * @param width Width of the viewport to draw.
+ * @param height Height of the viewport to draw.
+ * @return Short summary for the debug message.
+ */
+std::string Map::benchmarkDraw(int iterations, int width, int height)
+{
+	const int oldWidth = getWidth();
+	const int oldHeight = getHeight();
+	setWidth(width);
+	setHeight(height);
+	_camera->resize();
+
+	const bool hadDrawThreads = (bool)_drawThreads;
+	std::unique_ptr<ThreadPool> bandThreads = std::move(_drawThreads);
+	if (!bandThreads && ThreadPool::getThreadCount(-1) > 1)
+	{
+		bandThreads = std::make_unique<ThreadPool>(ThreadPool::getThreadCount(-1) - 1);
+	}
+
+	std::ostringstream context;
+	context << getWidth() << "x" << getHeight();
+	Benchmark benchmark("Map draw", context.str());
+	for (int mode = 0; mode < 2; ++mode)
+	{
+		if (mode == 1)
+		{
+			if (!bandThreads)
+			{
+				break;
+			}
+			_drawThreads = std::move(bandThreads);
+		}
+		double ms = Benchmark::time([&]
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				_redraw = true;
+				draw();
+			}
+		});
+		std::ostringstream details;
+		details << ", " << (_drawThreads ? _drawThreads->size() + 1 : 1) << " threads";
+		benchmark.add(_drawThreads ? "bands" : "game thread", ms, iterations, "frame", details.str());
+	}
+
+	if (!hadDrawThreads)
+	{
+		_drawThreads.reset();
+	}
+	setWidth(oldWidth);
+	setHeight(oldHeight);
+	_camera->resize();
+	_redraw = true;
+	return benchmark.getSummary();
+}
+
+/**
+ * Measures how long it takes to draw all units still standing, running
+ * their recolor scripts for every pixel. Compare results of builds with
+ * different script dispatch and runs with `scriptFuseOps` on and off.
+ * Results are written to the log.
+ * @param iterations How many times every unit is drawn.
+ * @return Short summary for the debug message.
+ */
+std::string Map::benchmarkUnitSprites(int iterations)
+{
+	std::vector<BattleUnit*> units;
+	int parts = 0;
+	for (BattleUnit *unit : *_save->getUnits())
+	{
+		if (!unit->isOut())
+		{
+			units.push_back(unit);
+			parts += unit->getArmor()->getSize() * unit->getArmor()->getSize();
+		}
+	}
+	Surface area(_spriteWidth * 2, _spriteHeight * 2);
+	GraphSubset mask = GraphSubset(area.getWidth(), area.getHeight());
+
+	UnitSprite unitSprite(&area, _game->getMod(), _save, _animFrame, _save->getDepth() != 0);
+	double ms = Benchmark::time([&]
+	{
+		for (int i = 0; i < iterations; ++i)
+		{
+			for (BattleUnit *unit : units)
+			{
+				for (int part = 0; part < unit->getArmor()->getSize() * unit->getArmor()->getSize(); ++part)
+				{
+					unitSprite.draw(unit, part, _spriteWidth / 2, _spriteHeight / 2, 0, mask, false);
+				}
+			}
+		}
+	});
+
+	std::ostringstream context, mode;
+	context << units.size() << " units, " << parts << " sprite parts";
+	mode << ScriptWorkerBase::getDispatchName() << " dispatch, fusion " << (Options::scriptFuseOps ? "on" : "off");
+	Benchmark benchmark("Unit sprite", context.str());
+	benchmark.add(mode.str(), ms, iterations * parts, "draw");
+	return benchmark.getSummary();
+}
+
 /**
  * Replaces a certain amount of colors in the surface's palette.
  * @param colors Pointer to the set of colors.
@@ -670,8 +959,9 @@ void Map::drawUnit(UnitSprite &unitSprite, Tile *unitTile, Tile *currTile, Posit
 	}
 
 	Position tileScreenPosition;
-	_camera->convertMapToScreen(unitTile->getPosition() + Position(0,0, (-unitFromBelow) + (+unitFromAbove)), &tileScreenPosition);
-	tileScreenPosition += _camera->getMapOffset();
+	// relative to the current tile, it could be drawn with a shifted camera
+	_camera->convertMapToScreen(unitTile->getPosition() + Position(0,0, (-unitFromBelow) + (+unitFromAbove)) - currTile->getPosition(), &tileScreenPosition);
+	tileScreenPosition += currTileScreenPosition;
 
 	//get shade helpers
 	auto getTileShade = [&](Tile* tile)
@@ -727,10 +1017,10 @@ void Map::drawUnit(UnitSprite &unitSprite, Tile *unitTile, Tile *currTile, Posit
  * Draw the terrain.
  * Keep this function as optimised as possible. It's big to minimise overhead of function calls.
  * @param surface The surface to draw on.
+ * @param camera Camera to draw with, the map camera or a copy shifted to a part of the map.
  */
-void Map::drawTerrain(Surface *surface)
+void Map::drawTerrain(Surface *surface, Camera *camera)
 {
-	_isAltPressed = _game->isAltPressed(true);
 	int frameNumber = 0;
 	SurfaceRaw<const Uint8> tmpSurface;
 	Tile *tile;
@@ -742,7 +1032,7 @@ void Map::drawTerrain(Surface *surface)
 	int dummy;
 	BattleUnit *movingUnit = _save->getTileEngine()->getMovingUnit();
 	int tileShade, tileColor, obstacleShade;
-	UnitSprite unitSprite(surface, _game->getMod(), _save, _animFrame, _save->getDepth() != 0);
+	UnitSprite unitSprite(surface, _game->getMod(), _save, _animFrame, _save->getDepth() != 0, _spriteCache);
 	ItemSprite itemSprite(surface, _game->getMod(), _save, _animFrame);
 
 	const int halfAnimFrame = (_animFrame / 2) % 4;
@@ -778,18 +1068,18 @@ void Map::drawTerrain(Surface *surface)
 		bulletHighZ = bulletHighZ / 24;
 
 		// if the projectile is outside the viewport - center it back on it
-		_camera->convertVoxelToScreen(_projectile->getPosition(), &bulletPositionScreen);
+		camera->convertVoxelToScreen(_projectile->getPosition(), &bulletPositionScreen);
 
 		if (_projectileInFOV && _followProjectile)
 		{
-			Position newCam = _camera->getMapOffset();
+			Position newCam = camera->getMapOffset();
 			if (newCam.z != bulletHighZ) //switch level
 			{
 				newCam.z = bulletHighZ;
 				if (_projectileInFOV)
 				{
-					_camera->setMapOffset(newCam);
-					_camera->convertVoxelToScreen(_projectile->getPosition(), &bulletPositionScreen);
+					camera->setMapOffset(newCam);
+					camera->convertVoxelToScreen(_projectile->getPosition(), &bulletPositionScreen);
 				}
 			}
 			if (_smoothCamera)
@@ -800,8 +1090,8 @@ void Map::drawTerrain(Surface *surface)
 					if ((bulletPositionScreen.x < 1 || bulletPositionScreen.x > surface->getWidth() - 1 ||
 						bulletPositionScreen.y < 1 || bulletPositionScreen.y > _visibleMapHeight - 1))
 					{
-						_camera->centerOnPosition(Position(bulletLowX, bulletLowY, bulletHighZ), false);
-						_camera->convertVoxelToScreen(_projectile->getPosition(), &bulletPositionScreen);
+						camera->centerOnPosition(Position(bulletLowX, bulletLowY, bulletHighZ), false);
+						camera->convertVoxelToScreen(_projectile->getPosition(), &bulletPositionScreen);
 					}
 				}
 				if (!_smoothingEngaged)
@@ -814,7 +1104,7 @@ void Map::drawTerrain(Surface *surface)
 				}
 				else
 				{
-					_camera->jumpXY(surface->getWidth() / 2 - bulletPositionScreen.x, _visibleMapHeight / 2 - bulletPositionScreen.y);
+					camera->jumpXY(surface->getWidth() / 2 - bulletPositionScreen.x, _visibleMapHeight / 2 - bulletPositionScreen.y);
 				}
 			}
 			else
@@ -825,25 +1115,25 @@ void Map::drawTerrain(Surface *surface)
 					enough = true;
 					if (bulletPositionScreen.x < 0)
 					{
-						_camera->jumpXY(+surface->getWidth(), 0);
+						camera->jumpXY(+surface->getWidth(), 0);
 						enough = false;
 					}
 					else if (bulletPositionScreen.x > surface->getWidth())
 					{
-						_camera->jumpXY(-surface->getWidth(), 0);
+						camera->jumpXY(-surface->getWidth(), 0);
 						enough = false;
 					}
 					else if (bulletPositionScreen.y < 0)
 					{
-						_camera->jumpXY(0, +_visibleMapHeight);
+						camera->jumpXY(0, +_visibleMapHeight);
 						enough = false;
 					}
 					else if (bulletPositionScreen.y > _visibleMapHeight)
 					{
-						_camera->jumpXY(0, -_visibleMapHeight);
+						camera->jumpXY(0, -_visibleMapHeight);
 						enough = false;
 					}
-					_camera->convertVoxelToScreen(_projectile->getPosition(), &bulletPositionScreen);
+					camera->convertVoxelToScreen(_projectile->getPosition(), &bulletPositionScreen);
 				}
 				while (!enough);
 			}
@@ -851,20 +1141,20 @@ void Map::drawTerrain(Surface *surface)
 	}
 
 	// get corner map coordinates to give rough boundaries in which tiles to redraw are
-	_camera->convertScreenToMap(0, 0, &beginX, &dummy);
-	_camera->convertScreenToMap(surface->getWidth(), 0, &dummy, &beginY);
-	_camera->convertScreenToMap(surface->getWidth() + _spriteWidth, surface->getHeight() + _spriteHeight, &endX, &dummy);
-	_camera->convertScreenToMap(0, surface->getHeight() + _spriteHeight, &dummy, &endY);
-	beginY -= (_camera->getViewLevel() * 2);
-	beginX -= (_camera->getViewLevel() * 2);
+	camera->convertScreenToMap(0, 0, &beginX, &dummy);
+	camera->convertScreenToMap(surface->getWidth(), 0, &dummy, &beginY);
+	camera->convertScreenToMap(surface->getWidth() + _spriteWidth, surface->getHeight() + _spriteHeight, &endX, &dummy);
+	camera->convertScreenToMap(0, surface->getHeight() + _spriteHeight, &dummy, &endY);
+	beginY -= (camera->getViewLevel() * 2);
+	beginX -= (camera->getViewLevel() * 2);
 	if (beginX < 0)
 		beginX = 0;
 	if (beginY < 0)
 		beginY = 0;
 
-	if (!_camera->getShowAllLayers())
+	if (!camera->getShowAllLayers())
 	{
-		endZ = std::min(endZ, _camera->getViewLevel());
+		endZ = std::min(endZ, camera->getViewLevel());
 	}
 
 
@@ -883,7 +1173,7 @@ void Map::drawTerrain(Surface *surface)
 	}
 
 	surface->lock();
-	const auto cameraPos = _camera->getMapOffset();
+	const auto cameraPos = camera->getMapOffset();
 	for (int itZ = beginZ; itZ <= endZ; itZ++)
 	{
 		bool topLayer = itZ == endZ;
@@ -893,7 +1183,7 @@ void Map::drawTerrain(Surface *surface)
 			tile = _save->getTile(mapPosition);
 			for (int itX = beginX; itX < endX; itX++, mapPosition.x++, tile++)
 			{
-				_camera->convertMapToScreen(mapPosition, &screenPosition);
+				camera->convertMapToScreen(mapPosition, &screenPosition);
 				screenPosition += cameraPos;
 
 				// only render cells that are inside the surface
@@ -937,7 +1227,7 @@ void Map::drawTerrain(Surface *surface)
 					// Draw cursor back
 					if (_cursorType != CT_NONE && _selectorX > itX - _cursorSize && _selectorY > itY - _cursorSize && _selectorX < itX+1 && _selectorY < itY+1 && !_save->getBattleState()->getMouseOverIcons())
 					{
-						if (_camera->getViewLevel() == itZ)
+						if (camera->getViewLevel() == itZ)
 						{
 							if (_cursorType != CT_AIM)
 							{
@@ -956,7 +1246,7 @@ void Map::drawTerrain(Surface *surface)
 							tmpSurface = _game->getMod()->getSurfaceSet("CURSOR.PCK")->getFrame(frameNumber);
 							Surface::blitRaw(surface, tmpSurface, screenPosition.x, screenPosition.y, 0);
 						}
-						else if (_camera->getViewLevel() > itZ)
+						else if (camera->getViewLevel() > itZ)
 						{
 							frameNumber = 2; // blue box
 							tmpSurface = _game->getMod()->getSurfaceSet("CURSOR.PCK")->getFrame(frameNumber);
@@ -1078,7 +1368,7 @@ void Map::drawTerrain(Surface *surface)
 								voxelPos.z / 24 == itZ &&
 								_save->getTileEngine()->isVoxelVisible(voxelPos))
 							{
-								_camera->convertVoxelToScreen(voxelPos, &bulletPositionScreen);
+								camera->convertVoxelToScreen(voxelPos, &bulletPositionScreen);
 
 								itemSprite.drawShadow(item,
 									bulletPositionScreen.x - 16,
@@ -1095,7 +1385,7 @@ void Map::drawTerrain(Surface *surface)
 								voxelPos.z / 24 == itZ &&
 								_save->getTileEngine()->isVoxelVisible(voxelPos))
 							{
-								_camera->convertVoxelToScreen(voxelPos, &bulletPositionScreen);
+								camera->convertVoxelToScreen(voxelPos, &bulletPositionScreen);
 
 								itemSprite.draw(item,
 									bulletPositionScreen.x - 16,
@@ -1132,7 +1422,7 @@ void Map::drawTerrain(Surface *surface)
 											voxelPos.z / 24 == itZ &&
 											_save->getTileEngine()->isVoxelVisible(voxelPos))
 										{
-											_camera->convertVoxelToScreen(voxelPos, &bulletPositionScreen);
+											camera->convertVoxelToScreen(voxelPos, &bulletPositionScreen);
 											bulletPositionScreen.x -= tmpSurface.getWidth() / 2;
 											bulletPositionScreen.y -= tmpSurface.getHeight() / 2;
 											Surface::blitRaw(surface, tmpSurface, bulletPositionScreen.x, bulletPositionScreen.y, 16, false, _nvColor);
@@ -1145,7 +1435,7 @@ void Map::drawTerrain(Surface *surface)
 											voxelPos.z / 24 == itZ &&
 											_save->getTileEngine()->isVoxelVisible(voxelPos))
 										{
-											_camera->convertVoxelToScreen(voxelPos, &bulletPositionScreen);
+											camera->convertVoxelToScreen(voxelPos, &bulletPositionScreen);
 											bulletPositionScreen.x -= tmpSurface.getWidth() / 2;
 											bulletPositionScreen.y -= tmpSurface.getHeight() / 2;
 											Surface::blitRaw(surface, tmpSurface, bulletPositionScreen.x, bulletPositionScreen.y, 0, false, _nvColor);
@@ -1227,7 +1517,7 @@ void Map::drawTerrain(Surface *surface)
 										dest = transparetOffsets[dest];
 									}
 								},
-								ShaderSurface(this),
+								ShaderSurface(surface),
 								ShaderMove(pixelMask, vaporX, vaporY)
 							);
 						}
@@ -1268,7 +1558,7 @@ void Map::drawTerrain(Surface *surface)
 					// Draw cursor front
 					if (_cursorType != CT_NONE && _selectorX > itX - _cursorSize && _selectorY > itY - _cursorSize && _selectorX < itX+1 && _selectorY < itY+1 && !_save->getBattleState()->getMouseOverIcons())
 					{
-						if (_camera->getViewLevel() == itZ)
+						if (camera->getViewLevel() == itZ)
 						{
 							if (_cursorType != CT_AIM)
 							{
@@ -1480,13 +1770,13 @@ void Map::drawTerrain(Surface *surface)
 								_txtAccuracy->blitNShade(surface, screenPosition.x, screenPosition.y, 0);
 							}
 						}
-						else if (_camera->getViewLevel() > itZ)
+						else if (camera->getViewLevel() > itZ)
 						{
 							frameNumber = 5; // blue box
 							tmpSurface = _game->getMod()->getSurfaceSet("CURSOR.PCK")->getFrame(frameNumber);
 							Surface::blitRaw(surface, tmpSurface, screenPosition.x, screenPosition.y, 0);
 						}
-						if (!_isAltPressed && _cursorType > CT_AIM && _camera->getViewLevel() == itZ)
+						if (!_isAltPressed && _cursorType > CT_AIM && camera->getViewLevel() == itZ)
 						{
 							bool ignore = false;
 							if (_cursorType == CT_PSI || _cursorType == CT_WAYPOINT)
@@ -1559,8 +1849,8 @@ void Map::drawTerrain(Surface *surface)
 				for (int itY = beginY; itY <= endY; itY++)
 				{
 					mapPosition = Position(itX, itY, itZ);
-					_camera->convertMapToScreen(mapPosition, &screenPosition);
-					screenPosition += _camera->getMapOffset();
+					camera->convertMapToScreen(mapPosition, &screenPosition);
+					screenPosition += camera->getMapOffset();
 
 					// only render cells that are inside the surface
 					if (screenPosition.x > -_spriteWidth && screenPosition.x < surface->getWidth() + _spriteWidth &&
@@ -1643,10 +1933,10 @@ void Map::drawTerrain(Surface *surface)
 	}
 
 	auto selectedUnit = _save->getSelectedUnit();
-	if (selectedUnit && (_save->getSide() == FACTION_PLAYER || _save->getDebugMode()) && selectedUnit->getPosition().z <= _camera->getViewLevel())
+	if (selectedUnit && (_save->getSide() == FACTION_PLAYER || _save->getDebugMode()) && selectedUnit->getPosition().z <= camera->getViewLevel())
 	{
-		_camera->convertMapToScreen(selectedUnit->getPosition(), &screenPosition);
-		screenPosition += _camera->getMapOffset();
+		camera->convertMapToScreen(selectedUnit->getPosition(), &screenPosition);
+		screenPosition += camera->getMapOffset();
 		Position offset = calculateWalkingOffset(selectedUnit).ScreenOffset;
 		if (selectedUnit->isBigUnit())
 		{
@@ -1671,9 +1961,9 @@ void Map::drawTerrain(Surface *surface)
 			if (myUnit->getScannedTurn() == _save->getTurn() && myUnit->getFaction() != FACTION_PLAYER && !myUnit->isOut())
 			{
 				Position temp = myUnit->getPosition();
-				temp.z = _camera->getViewLevel();
-				_camera->convertMapToScreen(temp, &screenPosition);
-				screenPosition += _camera->getMapOffset();
+				temp.z = camera->getViewLevel();
+				camera->convertMapToScreen(temp, &screenPosition);
+				screenPosition += camera->getMapOffset();
 				Position offset;
 				//calculateWalkingOffset(myUnit, &offset);
 				if (myUnit->isBigUnit())
@@ -1705,10 +1995,10 @@ void Map::drawTerrain(Surface *surface)
 				continue; //for good
 			}
 			Position pos = objTile->getPosition();
-			if (pos.z <= _camera->getViewLevel() && objTile->getUnit() == 0 && objTile->isDiscovered(O_FLOOR))
+			if (pos.z <= camera->getViewLevel() && objTile->getUnit() == 0 && objTile->isDiscovered(O_FLOOR))
 			{
-				_camera->convertMapToScreen(pos, &screenPosition);
-				screenPosition += _camera->getMapOffset();
+				camera->convertMapToScreen(pos, &screenPosition);
+				screenPosition += camera->getMapOffset();
 				Position offset;
 				offset.y += 5;//(getTerrainLevel(pos, 10) - 4);
 				if (this->getCursorType() != CT_NONE)
@@ -1726,10 +2016,10 @@ void Map::drawTerrain(Surface *surface)
 	{
 		for (auto& pos : _save->getCraftTiles())
 		{
-			if (pos.z == _camera->getViewLevel())
+			if (pos.z == camera->getViewLevel())
 			{
-				_camera->convertMapToScreen(pos, &screenPosition);
-				screenPosition += _camera->getMapOffset();
+				camera->convertMapToScreen(pos, &screenPosition);
+				screenPosition += camera->getMapOffset();
 				screenPosition.y += 2; // based on vanilla soldier standHeight
 				_arrow->blitNShade(
 					surface,
@@ -1764,7 +2054,7 @@ void Map::drawTerrain(Surface *surface)
 		{
 			for (std::list<Explosion*>::const_iterator i = _explosions.begin(); i != _explosions.end(); ++i)
 			{
-				_camera->convertVoxelToScreen((*i)->getPosition(), &bulletPositionScreen);
+				camera->convertVoxelToScreen((*i)->getPosition(), &bulletPositionScreen);
 				if ((*i)->isBig())
 				{
 					if ((*i)->getCurrentFrame() >= 0)
@@ -1959,7 +2249,11 @@ void Map::setSelectorPosition(int mx, int my)
 
 	if (oldX != _selectorX || oldY != _selectorY)
 	{
-		_redraw = true;
+		if (beginDirtyRects())
+		{
+			invalidateCursor(oldX, oldY);
+			invalidateCursor(_selectorX, _selectorY);
+		}
 	}
 }
 
@@ -1972,6 +2266,16 @@ void Map::animate(bool redraw)
 	_save->nextAnimFrame();
 	_animFrame = _save->getAnimFrame();
 
+	bool dirtyRects = false;
+	if (redraw)
+	{
+		dirtyRects = beginDirtyRects();
+	}
+	else
+	{
+		_idleFrames = 0;
+	}
+
 	// random ambient sounds
 	{
 		if (!_save->getAmbienceRandom().empty())
@@ -1988,7 +2292,11 @@ void Map::animate(bool redraw)
 	// animate tiles
 	for (int i = 0; i < _save->getMapSizeXYZ(); ++i)
 	{
-		_save->getTile(i)->animate();
+		Tile *tile = _save->getTile(i);
+		if (tile->animate() && dirtyRects)
+		{
+			invalidateTile(tile->getPosition());
+		}
 	}
 
 	// init vapor vector
@@ -2069,7 +2377,230 @@ void Map::animate(bool redraw)
 		(*i)->breathe();
 	}
 
-	if (redraw) _redraw = true;
+	if (redraw && Options::battleDirtyRects)
+	{
+		invalidateIdleChanges();
+		_idleFrames++;
+	}
+}
+
+/**
+ * Starts a redraw of the map, which can be limited to dirty rectangles
+ * when the player is idle and no full redraw is pending already.
+ * @return True if only the tiles marked by invalidateTile will be redrawn.
+ */
+bool Map::beginDirtyRects()
+{
+	if (Options::battleDirtyRects && _idleFrames > 0 && (!_redraw || _dirtyRectsOnly))
+	{
+		_dirtyRectsOnly = true;
+	}
+	else
+	{
+		_dirtyRectsOnly = false;
+		_dirtyRects.clear();
+	}
+	_redraw = true;
+	return _dirtyRectsOnly;
+}
+
+/**
+ * Marks the screen area of a tile to be redrawn, merged with any dirty
+ * rectangle it overlaps. Falls back to redrawing the whole map
+ * when there are too many rectangles.
+ * @param pos Map position of the tile.
+ */
+void Map::invalidateTile(Position pos)
+{
+	if (!_dirtyRectsOnly || (pos.z > _camera->getViewLevel() && !_camera->getShowAllLayers()))
+	{
+		return;
+	}
+
+	Position screenPosition;
+	_camera->convertMapToScreen(pos, &screenPosition);
+	screenPosition += _camera->getMapOffset();
+
+	// enough to cover tall objects, units standing on the tile and the arrows above them
+	int left = std::max(screenPosition.x - _spriteWidth / 2, 0);
+	int top = std::max(screenPosition.y - _spriteHeight, 0);
+	int right = std::min(screenPosition.x + _spriteWidth * 3 / 2, getWidth());
+	int bottom = std::min(screenPosition.y + _spriteHeight * 3 / 2, getHeight());
+	if (left >= right || top >= bottom)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < _dirtyRects.size();)
+	{
+		const SDL_Rect& r = _dirtyRects[i];
+		if (left < r.x + r.w && r.x < right && top < r.y + r.h && r.y < bottom)
+		{
+			left = std::min(left, (int)r.x);
+			top = std::min(top, (int)r.y);
+			right = std::max(right, r.x + r.w);
+			bottom = std::max(bottom, r.y + r.h);
+			_dirtyRects[i] = _dirtyRects.back();
+			_dirtyRects.pop_back();
+			i = 0;
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	if (_dirtyRects.size() >= MAX_DIRTY_RECTS)
+	{
+		_dirtyRectsOnly = false;
+		_dirtyRects.clear();
+		return;
+	}
+	SDL_Rect rect;
+	rect.x = left;
+	rect.y = top;
+	rect.w = right - left;
+	rect.h = bottom - top;
+	_dirtyRects.push_back(rect);
+}
+
+/**
+ * Marks all tiles under the 3D cursor to be redrawn.
+ * @param x X position of the selector.
+ * @param y Y position of the selector.
+ */
+void Map::invalidateCursor(int x, int y)
+{
+	for (int dx = 0; dx < _cursorSize; ++dx)
+	{
+		for (int dy = 0; dy < _cursorSize; ++dy)
+		{
+			invalidateTile(Position(x + dx, y + dy, _camera->getViewLevel()));
+		}
+	}
+}
+
+/**
+ * Marks the tiles that change between animation frames while the player is idle:
+ * units, fire, smoke, vapor, animated items, the cursor, and tiles that
+ * changed light, visibility, items or units since the last frame.
+ */
+void Map::invalidateIdleChanges()
+{
+	const bool track = _dirtyRectsOnly;
+	if (_tileStates.size() != (size_t)_save->getMapSizeXYZ())
+	{
+		_tileStates.assign(_save->getMapSizeXYZ(), 0);
+	}
+	for (int i = 0; i < _save->getMapSizeXYZ(); ++i)
+	{
+		Tile *tile = _save->getTile(i);
+		Uint32 state = getTileState(tile);
+		if (track && (state != _tileStates[i] || tile->getFire() || tile->getSmoke()))
+		{
+			invalidateTile(tile->getPosition());
+		}
+		_tileStates[i] = state;
+	}
+	if (!track)
+	{
+		return;
+	}
+
+	// vapor is kept per column, sorted by height
+	const int topZ = _camera->getShowAllLayers() ? _save->getMapSizeZ() - 1 : _camera->getViewLevel();
+	for (size_t i = 0; i < _vaporParticles.size(); ++i)
+	{
+		int lastZ = -1;
+		for (const auto& p : _vaporParticles[i])
+		{
+			int z = std::min(p.getVoxelZ() / Position::TileZ, topZ);
+			if (z != lastZ)
+			{
+				invalidateTile(Position(i % _save->getMapSizeX(), i / _save->getMapSizeX(), z));
+				lastZ = z;
+			}
+		}
+	}
+
+	for (auto unit : *_save->getUnits())
+	{
+		if (unit->getPosition() == TileEngine::invalid || unit->isOut())
+		{
+			continue;
+		}
+		const int size = unit->getArmor()->getSize();
+		for (int x = 0; x < size; ++x)
+		{
+			for (int y = 0; y < size; ++y)
+			{
+				invalidateTile(unit->getPosition() + Position(x, y, 0));
+			}
+		}
+	}
+
+	for (auto item : *_save->getItems())
+	{
+		Tile *tile = item->getTile();
+		if (!tile || item->getOwner())
+		{
+			continue;
+		}
+		bool animated = item->getRules()->isMissionObjective() || !item->getRules()->getScript<ModScript::SelectItemSprite>().isDefault();
+		if (!animated)
+		{
+			ScriptWorkerBlit work;
+			BattleItem::ScriptFill(&work, item, _save, BODYPART_ITEM_FLOOR, _animFrame, 0);
+			animated = !work.isDefault();
+		}
+		if (animated)
+		{
+			invalidateTile(tile->getPosition());
+		}
+	}
+
+	if (_cursorType != CT_NONE)
+	{
+		invalidateCursor(_selectorX, _selectorY);
+	}
+}
+
+/**
+ * Packs everything about a tile that is drawn and can change without an animation frame.
+ * @param tile Pointer to the tile.
+ * @return Tile state.
+ */
+Uint32 Map::getTileState(Tile *tile) const
+{
+	return tile->getShade()
+		| (tile->isDiscovered(O_FLOOR) << 4)
+		| (tile->isDiscovered(O_WESTWALL) << 5)
+		| (tile->isDiscovered(O_NORTHWALL) << 6)
+		| ((tile->getVisible() != 0) << 7)
+		| (std::min<Uint32>(tile->getInventory()->size(), 255) << 8)
+		| ((tile->getUnit() != nullptr) << 16)
+		| ((tile->getPreview() + 1) << 17);
+}
+
+/**
+ * Collects everything that changes the whole map view at once,
+ * the map can't be redrawn in parts when any of it changed since the last draw.
+ * @param state Vector to fill with the view state.
+ */
+void Map::getViewState(std::vector<intptr_t> &state) const
+{
+	const Position cameraPos = _camera->getMapOffset();
+	const BattleAction *action = _save->getBattleGame()->getCurrentAction();
+	state = {
+		getWidth(), getHeight(),
+		cameraPos.x, cameraPos.y, cameraPos.z, _camera->getShowAllLayers(),
+		_cursorType, _cursorSize,
+		(intptr_t)_save->getSelectedUnit(), _save->getSide(), _save->getDebugMode(),
+		_save->getPathfinding()->isPathPreviewed(), (intptr_t)_waypoints.size(),
+		_nightVisionOn, _fadeShade, _debugVisionMode,
+		_save->getBattleState()->getMouseOverIcons(), _game->isCtrlPressed(true),
+		action->type, (intptr_t)action->weapon,
+	};
 }
 
 /**
@@ -24,6 +24,7 @@
 #include "Position.h"
 #include "Particle.h"
 #include <vector>
+#include <memory>
 
 namespace OpenXcom
 {
@@ -40,6 +41,8 @@ class Timer;
 class Text;
 class Tile;
 class UnitSprite;
+class SpriteVariantCache;
+class ThreadPool;
 
 enum CursorType { CT_NONE, CT_NORMAL, CT_AIM, CT_PSI, CT_WAYPOINT, CT_THROW };
 enum TilePart : int;
@@ -65,6 +68,10 @@ private:
 	static const int NIGHT_VISION_SHADE = 4;
 	static const int NIGHT_VISION_MAX_SHADE = 8;
 	static const int BULLET_SPRITES = 35;
+	static const int SPRITE_CACHE_SIZE = 4 * 1024 * 1024;
+	static const int MAX_DIRTY_RECTS = 32;
+	static const int MAX_DIRTY_AREA_PERCENT = 60;
+	static const int MIN_BAND_HEIGHT = 4;
 	Timer *_scrollMouseTimer, *_scrollKeyTimer, *_obstacleTimer;
 	Timer *_fadeTimer;
 	int _fadeShade;
@@ -102,9 +109,25 @@ private:
 	bool _previewSettingArrows, _previewSettingTu, _previewSettingEnergy;
 	Text *_txtAccuracy;
 	SurfaceSet *_projectileSet;
+	SpriteVariantCache *_spriteCache;
+	std::vector<SDL_Rect> _dirtyRects;
+	std::vector<Uint32> _tileStates;
+	std::vector<intptr_t> _viewState;
+	bool _dirtyRectsOnly;
+	int _idleFrames;
+	std::unique_ptr<ThreadPool> _drawThreads;
 
 	void drawUnit(UnitSprite &unitSprite, Tile *unitTile, Tile *currTile, Position tileScreenPosition, bool topLayer, BattleUnit* movingUnit = nullptr);
-	void drawTerrain(Surface *surface);
+	void drawTerrain(Surface *surface, Camera *camera);
+	void drawArea(const SDL_Rect &rect, Surface *area);
+	void drawDirtyRects();
+	bool drawBands();
+	bool beginDirtyRects();
+	void invalidateTile(Position pos);
+	void invalidateCursor(int x, int y);
+	void invalidateIdleChanges();
+	Uint32 getTileState(Tile *tile) const;
+	void getViewState(std::vector<intptr_t> &state) const;
 	int getTerrainLevel(const Position& pos, int size) const;
 	int getWallShade(TilePart part, Tile* tileFrot);
 	int _iconHeight, _iconWidth, _messageColor;
@@ -121,6 +144,10 @@ public:
 	void think() override;
 	/// Draws the surface.
 	void draw() override;
+	/// Measures how long full map draws take on the game thread and in bands.
+	std::string benchmarkDraw(int iterations, int width, int height);
+	/// Measures how long unit sprites take to draw with recolor scripts and from a sprite cache.
+	std::string benchmarkUnitSprites(int iterations);
 	/// Sets the palette.
 	void setPalette(const SDL_Color *colors, int firstcolor = 0, int ncolors = 256) override;
 	/// Special handling for mouse press.
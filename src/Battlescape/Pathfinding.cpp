@@ -18,15 +18,20 @@
  */
 #include <list>
 #include <algorithm>
+#include <sstream>
 #include "Pathfinding.h"
 #include "PathfindingOpenSet.h"
 #include "../Savegame/SavedBattleGame.h"
 #include "../Savegame/Tile.h"
 #include "../Mod/Armor.h"
 #include "../Savegame/BattleUnit.h"
+#include "../Mod/Unit.h"
 #include "../Engine/Options.h"
+#include "../Engine/Logger.h"
+#include "../Engine/Benchmark.h"
 #include "../fmath.h"
 #include "BattlescapeGame.h"
+#include "BattleSimulation.h"
 
 namespace OpenXcom
 {
@@ -35,6 +40,48 @@ constexpr int Pathfinding::dir_x[Pathfinding::dir_max];
 constexpr int Pathfinding::dir_y[Pathfinding::dir_max];
 constexpr int Pathfinding::dir_z[Pathfinding::dir_max];
 
+/**
+ * Result of findReachable, with all unit properties the search depends on.
+ * Player units are never cached, as their search depends on visibility of other units.
+ */
+struct Pathfinding::ReachableCacheEntry
+{
+	Position origin;
+	const Armor *armor;
+	MovementType movementType;
+	UnitFaction faction;
+	bool firePenalty;
+	ArmorMoveCost moveCostBase, moveCostBaseFly, moveCostBaseNormal;
+	PathfindingCost costMax;
+	std::vector<BattleUnit*> spottedUnits;
+	std::vector<int> tiles;
+
+	/// Creates key for given unit and costs.
+	ReachableCacheEntry(const BattleUnit *unit, PathfindingCost max) :
+		origin(unit->getPosition()), armor(unit->getArmor()), movementType(unit->getMovementType()), faction(unit->getFaction()),
+		firePenalty(unit->getSpecialAbility() < SPECAB_BURNFLOOR),
+		moveCostBase(unit->getMoveCostBase()), moveCostBaseFly(unit->getMoveCostBaseFly()), moveCostBaseNormal(unit->getMoveCostBaseNormal()),
+		costMax(max)
+	{
+		if (faction == FACTION_HOSTILE)
+		{
+			spottedUnits = unit->getUnitsSpottedThisTurn();
+		}
+	}
+
+	/// Checks if other entry was created for same search.
+	bool sameSearch(const ReachableCacheEntry &other) const
+	{
+		return origin == other.origin && armor == other.armor && movementType == other.movementType && faction == other.faction &&
+			firePenalty == other.firePenalty && moveCostBase == other.moveCostBase && moveCostBaseFly == other.moveCostBaseFly &&
+			moveCostBaseNormal == other.moveCostBaseNormal && costMax.time == other.costMax.time && costMax.energy == other.costMax.energy &&
+			spottedUnits == other.spottedUnits;
+	}
+};
+
+/// How many results are kept in reachable tiles cache.
+static constexpr size_t ReachableCacheSize = 64;
+
 int Pathfinding::red = 3;
 int Pathfinding::yellow = 10;
 int Pathfinding::green = 4;
@@ -43,7 +90,7 @@ int Pathfinding::green = 4;
  * Sets up a Pathfinding.
  * @param save pointer to SavedBattleGame object.
  */
-Pathfinding::Pathfinding(SavedBattleGame *save) : _save(save), _unit(0), _pathPreviewed(false), _strafeMove(false)
+Pathfinding::Pathfinding(SavedBattleGame *save) : _save(save), _unit(0), _pathPreviewed(false), _strafeMove(false), _bucketQueue(Options::pathfindingBucketQueue)
 {
 	_size = _save->getMapSizeXYZ();
 	// Initialize one node per tile
@@ -82,6 +129,7 @@ PathfindingNode *Pathfinding::getNode(Position pos)
  */
 void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleActionMove bam, const BattleUnit *missileTarget, int maxTUCost)
 {
+	BattleSimulation::PhaseTimer timer(SP_PATHFINDING);
 	_totalTUCost = {};
 	_path.clear();
 	// i'm DONE with these out of bounds errors.
@@ -187,13 +235,14 @@ bool Pathfinding::aStarPath(Position startPosition, Position endPosition, Battle
 	// start position is the first one in our "open" list
 	PathfindingNode *start = getNode(startPosition);
 	start->connect({}, 0, 0, endPosition);
-	PathfindingOpenSet openList;
-	openList.push(start);
+	_openSet.reset(_bucketQueue);
+	_openSet.push(start);
 	bool missile = (bam == BAM_MISSILE);
 	// if the open list is empty, we've reached the end
-	while (!openList.empty())
+	while (!_openSet.empty())
 	{
-		PathfindingNode *currentNode = openList.pop();
+		PathfindingNode *currentNode = _openSet.pop();
+		++_expandedNodes;
 		Position const &currentPos = currentNode->getPosition();
 		currentNode->setChecked();
 		if (currentPos == endPosition) // We found our target.
@@ -225,7 +274,7 @@ bool Pathfinding::aStarPath(Position startPosition, Position endPosition, Battle
 			if ((!nextNode->inOpenSet() || nextNode->getTUCost(missile).time > _totalTUCost.time) && _totalTUCost.time <= maxTUCost)
 			{
 				nextNode->connect(_totalTUCost, currentNode, direction, endPosition);
-				openList.push(nextNode);
+				_openSet.push(nextNode);
 			}
 		}
 	}
@@ -445,13 +494,13 @@ PathfindingStep Pathfinding::getTUCost(Position startPosition, int direction, co
 						// they're a special case unto themselves, if we can walk past them diagonally, it means we can go around,
 						// as there is no wall blocking us.
 		if (direction == 0 || direction == 7 || direction == 1)
-			wallcost += startTile[i]->getTUCost(O_NORTHWALL, movementType);
+			wallcost += getTerrainTUCost(unit, startTile[i], O_NORTHWALL, bam, missileTarget);
 		if (!triedStairsDown && (direction == 2 || direction == 1 || direction == 3))
-			wallcost += destinationTile[i]->getTUCost(O_WESTWALL, movementType);
+			wallcost += getTerrainTUCost(unit, destinationTile[i], O_WESTWALL, bam, missileTarget);
 		if (!triedStairsDown && (direction == 4 || direction == 3 || direction == 5))
-			wallcost += destinationTile[i]->getTUCost(O_NORTHWALL, movementType);
+			wallcost += getTerrainTUCost(unit, destinationTile[i], O_NORTHWALL, bam, missileTarget);
 		if (direction == 6 || direction == 5 || direction == 7)
-			wallcost += startTile[i]->getTUCost(O_WESTWALL, movementType);
+			wallcost += getTerrainTUCost(unit, startTile[i], O_WESTWALL, bam, missileTarget);
 
 		// for backward compatiblity (100 + 100 + 100 > 255) or for (255 + 10 > 255)
 		if (wallcost >= INVALID_MOVE_COST)
@@ -468,10 +517,10 @@ PathfindingStep Pathfinding::getTUCost(Position startPosition, int direction, co
 		// calculate the cost by adding floor walk cost and object walk cost
 		if (direction < DIR_UP)
 		{
-			cost += destinationTile[i]->getTUCost(O_FLOOR, movementType);
+			cost += getTerrainTUCost(unit, destinationTile[i], O_FLOOR, bam, missileTarget);
 			if (!triedStairsDown && !triedStairs && destinationTile[i]->getMapData(O_OBJECT))
 			{
-				cost += destinationTile[i]->getTUCost(O_OBJECT, movementType);
+				cost += getTerrainTUCost(unit, destinationTile[i], O_OBJECT, bam, missileTarget);
 			}
 			if (cost == 0)
 			{
@@ -805,6 +854,7 @@ bool Pathfinding::isBlocked(const BattleUnit *unit, const Tile *tile, const int
 
 /**
  * Determines whether going from one tile to another blocks movement.
+ * Uses terrain data cached for the movement type.
  * @param unit Unit that move.
  * @param startTile The tile to start from.
  * @param direction The direction we are facing.
@@ -813,6 +863,27 @@ bool Pathfinding::isBlocked(const BattleUnit *unit, const Tile *tile, const int
  * @return True if the movement is blocked.
  */
 bool Pathfinding::isBlockedDirection(const BattleUnit *unit, Tile *startTile, const int direction, BattleActionMove bam, const BattleUnit *missileTarget) const
+{
+	if (direction < 0 || direction >= DIR_UP)
+	{
+		return false;
+	}
+	int index;
+	const TerrainCache &terrain = getTerrain(unit, startTile, bam, missileTarget, index);
+	return terrain.blockedDirections[index] & (1 << direction);
+}
+
+/**
+ * Determines whether walls between start tile and the next one block movement.
+ * Only terrain is checked, so the result depends only on the tiles and the movement type.
+ * @param unit Unit that move.
+ * @param startTile The tile to start from.
+ * @param direction The direction we are facing.
+ * @param bam Move type.
+ * @param missileTarget Target for a missile.
+ * @return True if the movement is blocked.
+ */
+bool Pathfinding::isBlockedDirectionTerrain(const BattleUnit *unit, const Tile *startTile, const int direction, BattleActionMove bam, const BattleUnit *missileTarget) const
 {
 
 	// check if the difference in height between start and destination is not too high
@@ -888,6 +959,124 @@ bool Pathfinding::isBlockedDirection(const BattleUnit *unit, Tile *startTile, co
 	return isBlockedDirection(unit, startTile, direction, BAM_NORMAL, nullptr);
 }
 
+/**
+ * Gets terrain data cached for the movement type, recalculating the entry of the tile if it is outdated.
+ * @param unit Unit that move.
+ * @param tile The tile to get data for.
+ * @param bam Move type.
+ * @param missileTarget Target for a missile.
+ * @param index Set to the index of the tile in the cache arrays.
+ * @return Cache of the movement type.
+ */
+const Pathfinding::TerrainCache &Pathfinding::getTerrain(const BattleUnit *unit, const Tile *tile, BattleActionMove bam, const BattleUnit *missileTarget, int &index) const
+{
+	auto movementType = getMovementType(unit, missileTarget, bam);
+	TerrainCache &terrain = _terrain[missileTarget ? TERRAIN_MISSILE : movementType];
+	if (terrain.blockedDirections.empty())
+	{
+		terrain.blockedDirections.resize(_size, 0);
+		for (auto &cost : terrain.tuCost)
+		{
+			cost.resize(_size, 0);
+		}
+	}
+
+	index = _save->getTileIndex(tile->getPosition());
+	if (!(terrain.blockedDirections[index] & TERRAIN_CACHED))
+	{
+		Uint16 blocked = TERRAIN_CACHED;
+		for (int direction = 0; direction < DIR_UP; ++direction)
+		{
+			if (isBlockedDirectionTerrain(unit, tile, direction, bam, missileTarget))
+			{
+				blocked |= 1 << direction;
+			}
+		}
+		terrain.blockedDirections[index] = blocked;
+		for (int part = O_FLOOR; part < O_MAX; ++part)
+		{
+			terrain.tuCost[part][index] = Clamp(tile->getTUCost(part, movementType), 0, 0xFFFF);
+		}
+	}
+	return terrain;
+}
+
+/**
+ * Gets move cost of a tile part, from terrain data cached for the movement type.
+ * @param unit Unit that move.
+ * @param tile The tile.
+ * @param part Part of the tile.
+ * @param bam Move type.
+ * @param missileTarget Target for a missile.
+ * @return TU cost.
+ */
+int Pathfinding::getTerrainTUCost(const BattleUnit *unit, const Tile *tile, TilePart part, BattleActionMove bam, const BattleUnit *missileTarget) const
+{
+	int index;
+	const TerrainCache &terrain = getTerrain(unit, tile, bam, missileTarget, index);
+	return terrain.tuCost[part][index];
+}
+
+/**
+ * Drops all cached findReachable results.
+ * Called every time a unit changes its tile, or fire or smoke change.
+ */
+void Pathfinding::invalidateReachable()
+{
+	_reachableCache.clear();
+}
+
+/**
+ * Logs how often findReachable results were reused during the turn,
+ * then drops the cache as spotted units and unit states are reset for the next turn.
+ */
+void Pathfinding::endTurnReachable()
+{
+	if (_reachableCacheHits + _reachableCacheMisses > 0)
+	{
+		Log(LOG_DEBUG) << "Reachable tiles cache: " << _reachableCacheHits << " hits, " << _reachableCacheMisses << " misses ("
+			<< (_reachableCacheHits * 100 / (_reachableCacheHits + _reachableCacheMisses)) << "% hit rate)";
+	}
+	_reachableCacheHits = 0;
+	_reachableCacheMisses = 0;
+	invalidateReachable();
+}
+
+/**
+ * Marks cached terrain data as outdated for the tile and its neighbours,
+ * as blocking of diagonal moves depends on walls of adjacent tiles.
+ * Called every time terrain or door state of a tile changes.
+ * @param pos Position of the changed tile.
+ */
+void Pathfinding::invalidateTerrain(Position pos)
+{
+	invalidateReachable();
+	for (auto &terrain : _terrain)
+	{
+		if (terrain.blockedDirections.empty())
+		{
+			continue;
+		}
+		for (int y = pos.y - 1; y <= pos.y + 1; ++y)
+		{
+			for (int x = pos.x - 1; x <= pos.x + 1; ++x)
+			{
+				Position p(x, y, pos.z);
+				if (!_save->getTile(p))
+				{
+					continue;
+				}
+				size_t index = _save->getTileIndex(p);
+				if (index < terrain.blockedDirections.size())
+				{
+					terrain.blockedDirections[index] = 0;
+				}
+			}
+		}
+	}
+}
+
+
 /**
  * Determines whether a unit can fall down from this tile.
  * We can fall down here, if the tile does not exist, the tile has no floor
@@ -1314,31 +1503,69 @@ bool Pathfinding::bresenhamPath(Position origin, Position target, BattleActionMo
 
 /**
  * Locates all tiles reachable to @a *unit with a TU cost no more than @a tuMax.
- * Uses Dijkstra's algorithm.
+ * Results for AI units are kept until a unit moves or terrain, fire or smoke change,
+ * so repeated searches from the same position during a turn are free.
  * @param unit Pointer to the unit.
- * @param tuMax The maximum cost of the path to each tile.
+ * @param cost Cost of action the unit wants to do after moving.
  * @return An array of reachable tiles, sorted in ascending order of cost. The first tile is the start location.
  */
 std::vector<int> Pathfinding::findReachable(const BattleUnit *unit, const BattleActionCost &cost)
 {
-	const Position start = unit->getPosition();
+	BattleSimulation::PhaseTimer timer(SP_PATHFINDING);
 	int tuMax = unit->getTimeUnits() - cost.Time;
 	int energyMax = unit->getEnergy() - cost.Energy;
 
 	PathfindingCost costMax = { tuMax, energyMax };
 
+	if (!Options::pathfindingReachableCache || unit->getFaction() == FACTION_PLAYER)
+	{
+		return calculateReachable(unit, costMax);
+	}
+
+	ReachableCacheEntry entry(unit, costMax);
+	for (const auto &cached : _reachableCache)
+	{
+		if (cached.sameSearch(entry))
+		{
+			++_reachableCacheHits;
+			return cached.tiles;
+		}
+	}
+	++_reachableCacheMisses;
+
+	entry.tiles = calculateReachable(unit, costMax);
+	if (_reachableCache.size() >= ReachableCacheSize)
+	{
+		_reachableCache.erase(_reachableCache.begin());
+	}
+	_reachableCache.push_back(entry);
+	return entry.tiles;
+}
+
+/**
+ * Locates all tiles reachable to @a *unit with a cost no more than @a costMax.
+ * Uses Dijkstra's algorithm.
+ * @param unit Pointer to the unit.
+ * @param costMax The maximum cost of the path to each tile.
+ * @return An array of reachable tiles, sorted in ascending order of cost. The first tile is the start location.
+ */
+std::vector<int> Pathfinding::calculateReachable(const BattleUnit *unit, PathfindingCost costMax)
+{
+	const Position start = unit->getPosition();
+
 	for (std::vector<PathfindingNode>::iterator it = _nodes.begin(); it != _nodes.end(); ++it)
 	{
 		it->reset();
 	}
 	PathfindingNode *startNode = getNode(start);
 	startNode->connect({}, 0, 0);
-	PathfindingOpenSet unvisited;
-	unvisited.push(startNode);
+	_openSet.reset(_bucketQueue);
+	_openSet.push(startNode);
 	std::vector<PathfindingNode*> reachable;
-	while (!unvisited.empty())
+	while (!_openSet.empty())
 	{
-		PathfindingNode *currentNode = unvisited.pop();
+		PathfindingNode *currentNode = _openSet.pop();
+		++_expandedNodes;
 		Position const &currentPos = currentNode->getPosition();
 
 		// Try all reachable neighbours.
@@ -1357,7 +1584,7 @@ std::vector<int> Pathfinding::findReachable(const BattleUnit *unit, const Battle
 			if (!nextNode->inOpenSet() || nextNode->getTUCost(false).time > totalTuCost.time)
 			{
 				nextNode->connect(totalTuCost, currentNode, direction);
-				unvisited.push(nextNode);
+				_openSet.push(nextNode);
 			}
 		}
 		currentNode->setChecked();
@@ -1418,4 +1645,67 @@ std::vector<int> Pathfinding::copyPath() const
 	return _path;
 }
 
+/**
+ * Runs the same searches with the binary heap and the bucket queue
+ * and logs how many nodes each of them expands per second.
+ * Searches cover the whole map: reachable tiles of the unit and
+ * unlimited paths to a grid of destinations on its level.
+ * @param unit Unit used for the searches.
+ * @param iterations How many times to repeat the searches.
+ * @return Short summary of the results.
+ */
+std::string Pathfinding::benchmark(BattleUnit *unit, int iterations)
+{
+	BattleUnit *oldUnit = _unit;
+	std::vector<int> oldPath = _path;
+	PathfindingCost oldTUCost = _totalTUCost;
+	bool oldBucketQueue = _bucketQueue;
+
+	const Position origin = unit->getPosition();
+	const int size = unit->getArmor()->getSize();
+	std::vector<Position> targets;
+	for (int y = 0; y < 4; ++y)
+	{
+		for (int x = 0; x < 4; ++x)
+		{
+			targets.push_back(Position((_save->getMapSizeX() - size) * (2 * x + 1) / 8, (_save->getMapSizeY() - size) * (2 * y + 1) / 8, origin.z));
+		}
+	}
+
+	std::ostringstream context;
+	context << "map " << _save->getMapSizeX() << "x" << _save->getMapSizeY() << "x" << _save->getMapSizeZ();
+	Benchmark benchmark("Pathfinding", context.str());
+	for (int mode = 0; mode < 2; ++mode)
+	{
+		_bucketQueue = (mode == 1);
+		_expandedNodes = 0;
+		size_t reachable = 0;
+		int found = 0;
+		double ms = Benchmark::time([&]
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				reachable += calculateReachable(unit, { unit->getTimeUnits(), unit->getEnergy() }).size();
+				_unit = unit;
+				for (const auto &target : targets)
+				{
+					if (aStarPath(origin, target, BAM_NORMAL, nullptr, false, 10000))
+					{
+						++found;
+					}
+				}
+			}
+		});
+		std::ostringstream details;
+		details << ", " << reachable << " reachable tiles, " << found << " paths found";
+		benchmark.add(_bucketQueue ? "bucket queue" : "binary heap", ms, _expandedNodes, "expansion", details.str());
+	}
+
+	_bucketQueue = oldBucketQueue;
+	_totalTUCost = oldTUCost;
+	_path = oldPath;
+	_unit = oldUnit;
+	return benchmark.getSummary();
+}
+
 }
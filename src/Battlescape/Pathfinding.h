@@ -18,8 +18,10 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <vector>
+#include <string>
 #include "Position.h"
 #include "PathfindingNode.h"
+#include "PathfindingOpenSet.h"
 #include "../Mod/MapData.h"
 
 namespace OpenXcom
@@ -53,6 +55,39 @@ private:
 	bool _ctrlUsed = false;
 	bool _altUsed = false;
 	PathfindingCost _totalTUCost;
+	PathfindingOpenSet _openSet;
+	bool _bucketQueue;
+	size_t _expandedNodes = 0;
+
+	/**
+	 * Terrain data used by path search for one movement type,
+	 * stored as separate arrays indexed by tile index.
+	 */
+	struct TerrainCache
+	{
+		/// Directions blocked by walls (bits 0-7), with TERRAIN_CACHED set when entry is up to date.
+		std::vector<Uint16> blockedDirections;
+		/// Move cost of each tile part.
+		std::vector<Uint16> tuCost[O_MAX];
+	};
+	/// Missiles have own cache as closed doors block them.
+	static constexpr int TERRAIN_MISSILE = MT_SINK + 1;
+	static constexpr int TERRAIN_MAX = TERRAIN_MISSILE + 1;
+	static constexpr Uint16 TERRAIN_CACHED = 0x100;
+	mutable TerrainCache _terrain[TERRAIN_MAX];
+
+	/// Result of findReachable with everything it depends on.
+	struct ReachableCacheEntry;
+	std::vector<ReachableCacheEntry> _reachableCache;
+	size_t _reachableCacheHits = 0;
+	size_t _reachableCacheMisses = 0;
+
+	/// Gets cached terrain data for a tile, recalculating it if needed.
+	const TerrainCache &getTerrain(const BattleUnit *unit, const Tile *tile, BattleActionMove bam, const BattleUnit *missileTarget, int &index) const;
+	/// Gets cached move cost of a tile part.
+	int getTerrainTUCost(const BattleUnit *unit, const Tile *tile, TilePart part, BattleActionMove bam, const BattleUnit *missileTarget) const;
+	/// Determines whether walls between start tile and next tile block the direction, without using the cache.
+	bool isBlockedDirectionTerrain(const BattleUnit *unit, const Tile *startTile, const int direction, BattleActionMove bam, const BattleUnit *missileTarget) const;
 
 	/// Gets the node at certain position.
 	PathfindingNode *getNode(Position pos);
@@ -67,6 +102,8 @@ private:
 	bool bresenhamPath(Position origin, Position target, BattleActionMove bam, const BattleUnit *missileTarget, bool sneak = false, int maxTUCost = 1000);
 	/// Tries to find a path between two positions.
 	bool aStarPath(Position origin, Position target, BattleActionMove bam, const BattleUnit *missileTarget, bool sneak = false, int maxTUCost = 1000);
+	/// Locates all reachable tiles, without using the cache.
+	std::vector<int> calculateReachable(const BattleUnit *unit, PathfindingCost costMax);
 	/// Determines whether a unit can fall down from this tile.
 	bool canFallDown(Tile *destinationTile) const;
 	/// Determines whether a unit can fall down from this tile.
@@ -177,6 +214,14 @@ public:
 	const std::vector<int> &getPath() const;
 	/// Makes a copy to the path.
 	std::vector<int> copyPath() const;
+	/// Marks cached terrain data around a tile as outdated.
+	void invalidateTerrain(Position pos);
+	/// Drops all cached reachable tiles.
+	void invalidateReachable();
+	/// Logs reachable tiles cache statistics and starts new turn.
+	void endTurnReachable();
+	/// Compares node expansion speed of open set implementations.
+	std::string benchmark(BattleUnit *unit, int iterations);
 };
 
 }
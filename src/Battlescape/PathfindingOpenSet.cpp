@@ -17,12 +17,22 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <assert.h>
+#include <algorithm>
 #include "PathfindingOpenSet.h"
 #include "PathfindingNode.h"
 
 namespace OpenXcom
 {
 
+/**
+ * Creates an empty set.
+ * @param buckets Use bucket queue instead of binary heap.
+ */
+PathfindingOpenSet::PathfindingOpenSet(bool buckets) : _minBucket(0), _count(0), _useBuckets(buckets)
+{
+
+}
+
 /**
  * Cleans up all the entries still in set.
  */
@@ -31,14 +41,55 @@ PathfindingOpenSet::~PathfindingOpenSet()
 
 }
 
+/**
+ * Removes all entries, allocated memory is kept for the next search.
+ * @param buckets Use bucket queue instead of binary heap.
+ */
+void PathfindingOpenSet::reset(bool buckets)
+{
+	_heap.clear();
+	for (auto& b : _buckets)
+	{
+		b.clear();
+	}
+	_minBucket = 0;
+	_count = 0;
+	_useBuckets = buckets;
+}
+
 /**
  * Keeps removing all discarded entries that have come to the top of the queue.
  */
 void PathfindingOpenSet::removeDiscarded()
 {
-	while (!_queue.empty() && _queue.top()._node->_openentry != _queue.top()._openentry)
+	if (_useBuckets)
+	{
+		while (_count)
+		{
+			std::vector<OpenSetEntry> &bucket = _buckets[_minBucket];
+			if (bucket.empty())
+			{
+				++_minBucket;
+			}
+			else if (bucket.back()._node->_openentry != bucket.back()._openentry)
+			{
+				bucket.pop_back();
+				--_count;
+			}
+			else
+			{
+				break;
+			}
+		}
+	}
+	else
 	{
-		_queue.pop();
+		while (!_heap.empty() && _heap.front()._node->_openentry != _heap.front()._openentry)
+		{
+			std::pop_heap(_heap.begin(), _heap.end(), EntryCompare());
+			_heap.pop_back();
+			--_count;
+		}
 	}
 }
 
@@ -51,8 +102,20 @@ PathfindingNode *PathfindingOpenSet::pop()
 {
 	assert(!empty());
 
-	PathfindingNode *nd = _queue.top()._node;
-	_queue.pop();
+	PathfindingNode *nd;
+	if (_useBuckets)
+	{
+		std::vector<OpenSetEntry> &bucket = _buckets[_minBucket];
+		nd = bucket.back()._node;
+		bucket.pop_back();
+	}
+	else
+	{
+		nd = _heap.front()._node;
+		std::pop_heap(_heap.begin(), _heap.end(), EntryCompare());
+		_heap.pop_back();
+	}
+	--_count;
 	nd->_openentry = 0;
 
 	// Discarded entries might be visible now.
@@ -74,7 +137,24 @@ void PathfindingOpenSet::push(PathfindingNode *node)
 	entry._node = node;
 	entry._cost = node->getTUCost(false).time * 4 + node->getTUGuess(); //HACK: this is not real cost, more rough approximation for algorithm, as bonus `getTUGuess` work more like gravity/potential than normal cost.
 	entry._openentry = ++node->_openentry; // next unique number, used to check if old recode is still valid.
-	_queue.push(entry);
+	++_count;
+	if (_useBuckets)
+	{
+		assert(entry._cost >= 0);
+		const size_t cost = entry._cost;
+		if (cost >= _buckets.size())
+		{
+			_buckets.resize(cost + 1);
+		}
+		_buckets[cost].push_back(entry);
+		// guess is not consistent, new entry can be cheaper than the last popped one
+		_minBucket = _count == 1 ? cost : std::min(_minBucket, cost);
+	}
+	else
+	{
+		_heap.push_back(entry);
+		std::push_heap(_heap.begin(), _heap.end(), EntryCompare());
+	}
 }
 
 
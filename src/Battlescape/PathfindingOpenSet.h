@@ -17,7 +17,7 @@
  * You should have received a copy of the GNU General Public License
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <queue>
+#include <vector>
 #include <SDL_stdinc.h>
 
 namespace OpenXcom
@@ -52,21 +52,36 @@ public:
 
 /**
  * A class that holds references to the nodes to be examined in pathfinding.
+ * Entries are kept either in a binary heap or in a bucket queue (Dial's algorithm),
+ * the latter uses that costs are small non-negative integers.
+ * Memory is kept between searches, use `reset` to start a new one.
  */
 class PathfindingOpenSet
 {
 public:
+	/// Creates an empty set.
+	PathfindingOpenSet(bool buckets = false);
 	/// Cleans up the set and frees allocated memory.
 	~PathfindingOpenSet();
+	/// Removes all entries and selects the queue type.
+	void reset(bool buckets);
 	/// Gets the next node to check.
 	PathfindingNode *pop();
 	/// Adds a node to the set.
 	void push(PathfindingNode *node);
 	/// Is the set empty?
-	bool empty() const { return _queue.empty(); }
+	bool empty() const { return _count == 0; }
 
 private:
-	std::priority_queue<OpenSetEntry, std::vector<OpenSetEntry>, EntryCompare> _queue;
+	/// Binary heap ordered by EntryCompare.
+	std::vector<OpenSetEntry> _heap;
+	/// Entries grouped by cost, each bucket used as a stack.
+	std::vector<std::vector<OpenSetEntry>> _buckets;
+	/// Lowest cost that can have a non empty bucket.
+	size_t _minBucket;
+	/// Number of entries including discarded ones.
+	size_t _count;
+	bool _useBuckets;
 
 	/// Removes reachable discarded entries.
 	void removeDiscarded();
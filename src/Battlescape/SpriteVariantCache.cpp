@@ -0,0 +1,144 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SpriteVariantCache.h"
+#include <functional>
+
+namespace OpenXcom
+{
+
+/**
+ * Creates an empty cache.
+ * @param memoryLimit Pixel memory the variants can use, in bytes.
+ */
+SpriteVariantCache::SpriteVariantCache(size_t memoryLimit) : _memory(0), _memoryLimit(memoryLimit)
+{
+
+}
+
+/**
+ * Deletes all variants.
+ */
+SpriteVariantCache::~SpriteVariantCache()
+{
+
+}
+
+/**
+ * Combines everything that identifies a variant.
+ * @param src Source sprite.
+ * @param recolor Unit recolor pairs.
+ * @param burn Burn value.
+ * @param shade Shade value.
+ * @return Hash of the variant.
+ */
+size_t SpriteVariantCache::getHash(const Surface *src, const Recolor &recolor, int burn, int shade)
+{
+	size_t hash = std::hash<const Surface*>()(src);
+	auto combine = [&](size_t v)
+	{
+		hash ^= v + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	};
+	combine(burn);
+	combine(shade);
+	for (const auto &p : recolor)
+	{
+		combine(p.first << 8 | p.second);
+	}
+	return hash;
+}
+
+/**
+ * Removes a variant and its index entry.
+ * @param it Variant to remove.
+ */
+void SpriteVariantCache::remove(std::list<Variant>::iterator it)
+{
+	_memory -= it->surface->getWidth() * it->surface->getHeight();
+	_index.erase(it->hash);
+	_variants.erase(it);
+}
+
+/**
+ * Gets a variant of a sprite drawn before, and marks it as recently used.
+ * @param src Source sprite.
+ * @param recolor Unit recolor pairs, empty if the script doesn't use them.
+ * @param burn Burn value.
+ * @param shade Shade value.
+ * @return Recolored sprite, or null if there is none.
+ */
+std::shared_ptr<const Surface> SpriteVariantCache::get(const Surface *src, const Recolor &recolor, int burn, int shade)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto i = _index.find(getHash(src, recolor, burn, shade));
+	if (i == _index.end())
+	{
+		return nullptr;
+	}
+	auto it = i->second;
+	if (it->src != src || it->burn != burn || it->shade != shade || it->recolor != recolor)
+	{
+		return nullptr;
+	}
+	_variants.splice(_variants.begin(), _variants, it);
+	return it->surface;
+}
+
+/**
+ * Adds a variant of a sprite, dropping the least recently used
+ * variants when over the memory limit. A variant with the same hash is replaced,
+ * this includes the same variant drawn meanwhile by another thread.
+ * @param src Source sprite.
+ * @param recolor Unit recolor pairs, empty if the script doesn't use them.
+ * @param burn Burn value.
+ * @param shade Shade value.
+ * @param variant Recolored sprite, of the size of the source sprite.
+ */
+void SpriteVariantCache::add(const Surface *src, const Recolor &recolor, int burn, int shade, std::shared_ptr<const Surface> variant)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	size_t hash = getHash(src, recolor, burn, shade);
+	auto i = _index.find(hash);
+	if (i != _index.end())
+	{
+		remove(i->second);
+	}
+
+	size_t size = src->getWidth() * src->getHeight();
+	while (!_variants.empty() && _memory + size > _memoryLimit)
+	{
+		remove(std::prev(_variants.end()));
+	}
+
+	_variants.push_front(Variant{ src, recolor, burn, shade, hash, std::move(variant) });
+	_index[hash] = _variants.begin();
+	_memory += size;
+}
+
+/**
+ * Removes all variants.
+ */
+void SpriteVariantCache::clear()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_index.clear();
+	_variants.clear();
+	_memory = 0;
+}
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <SDL_types.h>
+#include "../Engine/Surface.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Keeps recolored copies of unit and item sprites, so units drawn
+ * by default recolor scripts don't run them for every pixel each frame.
+ * Variants are identified by source frame and every input the default
+ * scripts read, the least recently used ones are dropped when
+ * the memory limit is reached.
+ * The cache can be shared by callers drawing on several threads, its lock
+ * is only held while looking up and storing variants, and variants stay
+ * alive while they are drawn even if evicted meanwhile.
+ */
+class SpriteVariantCache
+{
+public:
+	using Recolor = std::vector<std::pair<Uint8, Uint8> >;
+
+private:
+	struct Variant
+	{
+		const Surface *src;
+		Recolor recolor;
+		int burn, shade;
+		size_t hash;
+		std::shared_ptr<const Surface> surface;
+	};
+
+	std::list<Variant> _variants;
+	std::unordered_map<size_t, std::list<Variant>::iterator> _index;
+	size_t _memory, _memoryLimit;
+	std::mutex _mutex;
+
+	/// Gets the hash of a variant.
+	static size_t getHash(const Surface *src, const Recolor &recolor, int burn, int shade);
+	/// Removes a variant.
+	void remove(std::list<Variant>::iterator it);
+public:
+	/// Creates an empty cache.
+	SpriteVariantCache(size_t memoryLimit);
+	/// Cleans up the cache.
+	~SpriteVariantCache();
+	/// Gets a variant of a sprite, if it was drawn before.
+	std::shared_ptr<const Surface> get(const Surface *src, const Recolor &recolor, int burn, int shade);
+	/// Adds a variant of a sprite drawn by the caller.
+	void add(const Surface *src, const Recolor &recolor, int burn, int shade, std::shared_ptr<const Surface> variant);
+	/// Removes all variants.
+	void clear();
+};
+
+}
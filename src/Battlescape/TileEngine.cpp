@@ -18,6 +18,7 @@
  */
 #include <assert.h>
 #include <set>
+#include <sstream>
 #include "TileEngine.h"
 #include "AIModule.h"
 #include "Map.h"
@@ -32,7 +33,9 @@
 #include "../Savegame/HitLog.h"
 #include "../Engine/RNG.h"
 #include "../Engine/GraphSubset.h"
+#include "../Engine/ThreadPool.h"
 #include "BattlescapeState.h"
+#include "BattleSimulation.h"
 #include "../Mod/MapDataSet.h"
 #include "../Mod/Unit.h"
 #include "../Mod/Mod.h"
@@ -40,6 +43,7 @@
 #include "../Mod/RuleSkill.h"
 #include "Pathfinding.h"
 #include "../Engine/Options.h"
+#include "../Engine/Benchmark.h"
 #include "ProjectileFlyBState.h"
 #include "MeleeAttackBState.h"
 #include "../fmath.h"
@@ -49,6 +53,34 @@ namespace OpenXcom
 namespace
 {
 
+/**
+ * Last tile looked up by voxelCheck.
+ * Kept per thread, so line of fire checks can run on AI worker threads.
+ */
+struct VoxelCheckCache
+{
+	const TileEngine *engine = nullptr;
+	Position pos = TileEngine::invalid;
+	Tile *tile = nullptr;
+	Tile *tileBelow = nullptr;
+};
+
+thread_local VoxelCheckCache voxelCheckCache;
+
+/// Max number of changed tiles kept for incremental field of view, above that all units get full update.
+constexpr size_t FieldOfViewMaxChanges = 256;
+/// Max number of changed tiles in sight of single unit that are updated incrementally.
+constexpr size_t FieldOfViewMaxUnitChanges = 8;
+
+/**
+ * Tile reached by explosion ray, with power left at that point.
+ */
+struct ExplosionStep
+{
+	Tile *tile;
+	int power;
+};
+
 /**
  * Calculates a line trajectory, using bresenham algorithm in 3D.
  * @param origin Origin.
@@ -159,6 +191,106 @@ bool calculateLineHelper(const Position& origin, const Position& target, FuncNew
 	return false;
 }
 
+/**
+ * Bresenham lines of many rays, stepped together one point along the longest axis at a time.
+ * Every axis is kept in a separate array so the compiler can vectorize the stepping,
+ * points of each ray are visited in the same order as calculateLineHelper visits them.
+ */
+struct LineBatch
+{
+	static constexpr int MaxLines = 64;
+
+	int x[MaxLines], y[MaxLines], z[MaxLines], endX[MaxLines];
+	int deltaX[MaxLines], deltaY[MaxLines], deltaZ[MaxLines];
+	int stepX[MaxLines], stepY[MaxLines], stepZ[MaxLines];
+	int driftXY[MaxLines], driftXZ[MaxLines];
+	Uint8 swapXY[MaxLines], swapXZ[MaxLines];
+
+	/// Points visited in current step: position on longest axis, then side steps in y and z plane.
+	int pointX[3][MaxLines], pointY[3][MaxLines], pointZ[3][MaxLines];
+	Uint8 pointValid[3][MaxLines];
+	/// Current step reached the end of line.
+	Uint8 last[MaxLines];
+
+	/**
+	 * Starts a line, same as calculateLineHelper.
+	 */
+	void setup(int l, const Position& origin, const Position& target)
+	{
+		int x0 = origin.x, x1 = target.x;
+		int y0 = origin.y, y1 = target.y;
+		int z0 = origin.z, z1 = target.z;
+
+		swapXY[l] = abs(y1 - y0) > abs(x1 - x0);
+		if (swapXY[l])
+		{
+			std::swap(x0, y0);
+			std::swap(x1, y1);
+		}
+		swapXZ[l] = abs(z1 - z0) > abs(x1 - x0);
+		if (swapXZ[l])
+		{
+			std::swap(x0, z0);
+			std::swap(x1, z1);
+		}
+
+		deltaX[l] = abs(x1 - x0);
+		deltaY[l] = abs(y1 - y0);
+		deltaZ[l] = abs(z1 - z0);
+		driftXY[l] = deltaX[l] / 2;
+		driftXZ[l] = deltaX[l] / 2;
+		stepX[l] = x0 > x1 ? -1 : 1;
+		stepY[l] = y0 > y1 ? -1 : 1;
+		stepZ[l] = z0 > z1 ? -1 : 1;
+		x[l] = x0;
+		y[l] = y0;
+		z[l] = z0;
+		endX[l] = x1;
+	}
+
+	/**
+	 * Stores point of a line, unswapped in reverse.
+	 */
+	void setPoint(int p, int l, int cx, int cy, int cz)
+	{
+		const int sx = swapXZ[l] ? cz : cx;
+		const int sz = swapXZ[l] ? cx : cz;
+		pointX[p][l] = swapXY[l] ? cy : sx;
+		pointY[p][l] = swapXY[l] ? sx : cy;
+		pointZ[p][l] = sz;
+	}
+
+	/**
+	 * Calculates points of next step of all lines.
+	 */
+	void step(int count)
+	{
+		for (int l = 0; l < count; ++l)
+		{
+			setPoint(0, l, x[l], y[l], z[l]);
+			pointValid[0][l] = 1;
+			last[l] = x[l] == endX[l];
+
+			driftXY[l] -= deltaY[l];
+			driftXZ[l] -= deltaZ[l];
+
+			const bool moveY = driftXY[l] < 0;
+			y[l] += moveY ? stepY[l] : 0;
+			driftXY[l] += moveY ? deltaX[l] : 0;
+			setPoint(1, l, x[l], y[l], z[l]);
+			pointValid[1][l] = moveY && !last[l];
+
+			const bool moveZ = driftXZ[l] < 0;
+			z[l] += moveZ ? stepZ[l] : 0;
+			driftXZ[l] += moveZ ? deltaX[l] : 0;
+			setPoint(2, l, x[l], y[l], z[l]);
+			pointValid[2][l] = moveZ && !last[l];
+
+			x[l] += stepX[l];
+		}
+	}
+};
+
 template<typename FuncNewPosition>
 bool calculateParabolaHelper(const Position& origin, const Position& target, double curvature, const Position& delta, FuncNewPosition posFunc)
 {
@@ -352,14 +484,17 @@ constexpr Position TileEngine::voxelTileCenter;
  * @param maxDarknessToSeeUnits Threshold of darkness for LoS calculation.
  */
 TileEngine::TileEngine(SavedBattleGame *save, Mod *mod) :
-	_save(save), _voxelData(mod->getVoxelData()), _inventorySlotGround(mod->getInventoryGround()), _personalLighting(true), _cacheTile(0), _cacheTileBelow(0),
+	_save(save), _voxelData(mod->getVoxelData()), _inventorySlotGround(mod->getInventoryGround()), _personalLighting(true),
+	_unitLightFootprints(Options::lightingUnitFootprints), _unitLightUpdate(0),
 	_maxViewDistance(mod->getMaxViewDistance()), _maxViewDistanceSq(_maxViewDistance * _maxViewDistance),
 	_maxVoxelViewDistance(_maxViewDistance * 16), _maxDarknessToSeeUnits(mod->getMaxDarknessToSeeUnits()),
 	_maxStaticLightDistance(mod->getMaxStaticLightDistance()), _maxDynamicLightDistance(mod->getMaxDynamicLightDistance()),
-	_enhancedLighting(mod->getEnhancedLighting())
+	_enhancedLighting(mod->getEnhancedLighting()),
+	_fovChangesBase(0), _fovRaysCast(0), _fovFullUpdates(0), _fovPartialUpdates(0), _fovSkippedUpdates(0),
+	_reactionChecks(0), _reactionCandidatesChecked(0), _reactionUnitsTotal(0)
 {
 	_blockVisibility.resize(save->getMapSizeXYZ());
-	_cacheTilePos = invalid;
+	voxelCheckFlush();
 
 	if (Options::oxceTogglePersonalLightType == 2)
 	{
@@ -519,77 +654,187 @@ void TileEngine::calculateTerrainItems(MapSubset gs)
   */
 void TileEngine::calculateUnitLighting(MapSubset gs)
 {
+	std::vector<LightEmitter> emitters;
 	for (BattleUnit *unit : *_save->getUnits())
 	{
-		if (unit->isOut())
+		getUnitLightEmitters(unit, emitters);
+		for (const LightEmitter &e : emitters)
 		{
-			continue;
+			addLight(gs, e.center, e.power, LL_UNITS, e.coneSize, e.direction);
 		}
+	}
+}
 
-		auto currLight = 0;
-		// add lighting of soldiers
-		if (_personalLighting && unit->getFaction() == FACTION_PLAYER)
-		{
-			currLight = std::max(currLight, unit->getArmor()->getPersonalLight());
-		}
-		const BattleItem *handWeapons[] = { unit->getLeftHandWeapon(), unit->getRightHandWeapon() };
-		for (const BattleItem *w : handWeapons)
-		{
-			if (!w) continue;
+/**
+ * Gets lights cast by a unit: personal light, glowing items in hands and fire.
+ * @param unit The unit.
+ * @param emitters Returned lights, one for every tile of the unit and light type.
+ */
+void TileEngine::getUnitLightEmitters(BattleUnit *unit, std::vector<LightEmitter> &emitters)
+{
+	emitters.clear();
+	if (unit->isOut())
+	{
+		return;
+	}
 
-			if (w->getItemConeSize() && w->getGlow() && w->getGlowRange() > currLight)
-			{
-				calculateUnitDirectionalLighting(gs, unit, w);
-			}
-			else if (w->getGlow())
-			{
-				currLight = std::max(currLight, w->getGlowRange());
-			}
+	const auto size = unit->getArmor()->getSize();
+	const auto pos = unit->getPosition();
+	auto currLight = 0;
+	// add lighting of soldiers
+	if (_personalLighting && unit->getFaction() == FACTION_PLAYER)
+	{
+		currLight = std::max(currLight, unit->getArmor()->getPersonalLight());
+	}
+	const BattleItem *handWeapons[] = { unit->getLeftHandWeapon(), unit->getRightHandWeapon() };
+	for (const BattleItem *w : handWeapons)
+	{
+		if (!w) continue;
 
-			auto u = w->getUnit();
-			if (u && u->getFire())
+		if (w->getItemConeSize() && w->getGlow() && w->getGlowRange() > currLight)
+		{
+			for (int x = 0; x < size; ++x)
 			{
-				currLight = std::max(currLight, unitFireLightPowerStunned);
+				for (int y = 0; y < size; ++y)
+				{
+					emitters.push_back({ pos + Position(x, y, 0), w->getGlowRange(), w->getItemConeSize(), unit->getDirection() });
+				}
 			}
 		}
-		// add lighting of units on fire
-		if (unit->getFire())
+		else if (w->getGlow())
 		{
-			currLight = std::max(currLight, unitFireLightPower);
+			currLight = std::max(currLight, w->getGlowRange());
 		}
 
-		if (currLight >= getMaxDynamicLightDistance())
+		auto u = w->getUnit();
+		if (u && u->getFire())
 		{
-			currLight = getMaxDynamicLightDistance() - 1;
+			currLight = std::max(currLight, unitFireLightPowerStunned);
 		}
-		const auto size = unit->getArmor()->getSize();
-		const auto pos = unit->getPosition();
+	}
+	// add lighting of units on fire
+	if (unit->getFire())
+	{
+		currLight = std::max(currLight, unitFireLightPower);
+	}
+
+	if (currLight >= getMaxDynamicLightDistance())
+	{
+		currLight = getMaxDynamicLightDistance() - 1;
+	}
+	if (currLight > 0)
+	{
 		for (int x = 0; x < size; ++x)
 		{
 			for (int y = 0; y < size; ++y)
 			{
-				addLight(gs, pos + Position(x, y, 0), currLight, LL_UNITS);
+				emitters.push_back({ pos + Position(x, y, 0), currLight, 0, 0 });
 			}
 		}
 	}
 }
 
-void TileEngine::calculateUnitDirectionalLighting(MapSubset gs, BattleUnit *unit, const BattleItem *w)
+/**
+ * Updates unit layer of lighting using light footprints of units.
+ * Footprint of a unit is recalculated only when its lights changed (it moved, turned, picked up a flare),
+ * then the unit layer is reset in old and new footprint area and all footprints are added back there.
+ * Footprints are calculated without regard to lower light layers, shade of tiles is the same as with full recalculation.
+ * @param dirty Areas where unit layer was reset and all footprints need to be added back.
+ */
+void TileEngine::updateUnitLighting(std::vector<MapSubset> &dirty)
 {
-	const auto size = unit->getArmor()->getSize();
-	const auto pos = unit->getPosition();
+	const auto mapSize = MapSubset{ _save->getMapSizeX(), _save->getMapSizeY() };
+	std::vector<LightEmitter> emitters;
 
-	for (int x = 0; x < size; ++x)
+	++_unitLightUpdate;
+	for (BattleUnit *unit : *_save->getUnits())
 	{
-		for (int y = 0; y < size; ++y)
+		getUnitLightEmitters(unit, emitters);
+		auto it = _unitLights.find(unit->getId());
+		if (it != _unitLights.end() && it->second.emitters == emitters)
+		{
+			it->second.update = _unitLightUpdate;
+			continue;
+		}
+		if (emitters.empty())
+		{
+			if (it != _unitLights.end())
+			{
+				dirty.push_back(it->second.area);
+				_unitLights.erase(it);
+			}
+			continue;
+		}
+
+		LightFootprint &footprint = _unitLights[unit->getId()];
+		if (footprint.area)
+		{
+			dirty.push_back(footprint.area);
+		}
+		footprint.emitters = emitters;
+		footprint.update = _unitLightUpdate;
+		footprint.area = MapSubset::intersection(mapArea(emitters[0].center, emitters[0].power - 1), mapSize);
+		for (const LightEmitter &e : emitters)
 		{
-			addLight(gs, pos + Position(x, y, 0), w->getGlowRange(), LL_UNITS, w->getItemConeSize(), unit->getDirection());
+			const auto area = MapSubset::intersection(mapArea(e.center, e.power - 1), mapSize);
+			footprint.area.beg_x = std::min(footprint.area.beg_x, area.beg_x);
+			footprint.area.beg_y = std::min(footprint.area.beg_y, area.beg_y);
+			footprint.area.end_x = std::max(footprint.area.end_x, area.end_x);
+			footprint.area.end_y = std::max(footprint.area.end_y, area.end_y);
+		}
+		footprint.light.assign(footprint.area.size_x() * footprint.area.size_y() * _save->getMapSizeZ(), 0);
+		for (const LightEmitter &e : emitters)
+		{
+			addLight(footprint.area, e.center, e.power, LL_UNITS, e.coneSize, e.direction, &footprint);
+		}
+		dirty.push_back(footprint.area);
+	}
+
+	// units removed from battle
+	for (auto it = _unitLights.begin(); it != _unitLights.end();)
+	{
+		if (it->second.update != _unitLightUpdate)
+		{
+			dirty.push_back(it->second.area);
+			it = _unitLights.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	for (const MapSubset &gs : dirty)
+	{
+		iterateTiles(
+			_save,
+			gs,
+			[&](Tile* tile)
+			{
+				tile->resetLight(LL_UNITS);
+			}
+		);
+	}
+	for (auto &unitLight : _unitLights)
+	{
+		LightFootprint &footprint = unitLight.second;
+		for (const MapSubset &gs : dirty)
+		{
+			iterateTiles(
+				_save,
+				MapSubset::intersection(footprint.area, gs),
+				[&](Tile* tile)
+				{
+					tile->addLight(footprint.at(tile->getPosition()), LL_UNITS);
+				}
+			);
 		}
 	}
 }
 
 void TileEngine::calculateLighting(LightLayers layer, Position position, int eventRadius, bool terrianChanged)
 {
+	BattleSimulation::PhaseTimer timer(SP_LIGHTING);
 	auto gsDynamic = MapSubset{ _save->getMapSizeX(), _save->getMapSizeY() };
 	auto gsStatic = gsDynamic;
 
@@ -599,8 +844,15 @@ void TileEngine::calculateLighting(LightLayers layer, Position position, int eve
 		gsStatic = mapArea(position, eventRadius + getMaxStaticLightDistance());
 	}
 
+	if (!_unitLightFootprints)
+	{
+		_unitLights.clear();
+	}
+
+	std::vector<MapSubset> unitsDirty;
 	if (terrianChanged)
 	{
+		std::vector<Position> fovChanges;
 		iterateTiles(
 			_save,
 			mapArea(position, position != invalid ? eventRadius + 1 : 1000),
@@ -610,6 +862,7 @@ void TileEngine::calculateLighting(LightLayers layer, Position position, int eve
 				const auto index = _save->getTileIndex(currPos);
 				const auto mapData = tile->getMapData(O_OBJECT);
 				auto &cache = _blockVisibility[index];
+				const auto oldCache = cache;
 
 				cache = {};
 				cache.height = -tile->getTerrainLevel();
@@ -643,35 +896,73 @@ void TileEngine::calculateLighting(LightLayers layer, Position position, int eve
 					tileNext = _save->getTile(currPos + pos + Position{ 0, 0, -1 });
 					addBlockDir(cache, dir, -1, verticalBlockage(tile, tileNext, DT_NONE) > 127);
 				}
+
+				// fire and smoke do not block tile visibility, only units
+				if (((oldCache.blockDir ^ cache.blockDir) & ~(MaskFire | MaskSmoke)) || oldCache.bigWall != cache.bigWall)
+				{
+					fovChanges.push_back(currPos);
+				}
 			}
 		);
+		addFieldOfViewChanges(fovChanges);
+
+		// light of units could be blocked differently now
+		const auto gsChanged = mapArea(position, position != invalid ? eventRadius + 1 : 1000);
+		for (auto it = _unitLights.begin(); it != _unitLights.end();)
+		{
+			if (MapSubset::intersection(it->second.area, gsChanged))
+			{
+				// new footprint can be smaller, old light needs to be reset too
+				unitsDirty.push_back(it->second.area);
+				it = _unitLights.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
 	}
 
-	if (layer <= LL_FIRE)
+	if (layer < LL_UNITS || !_unitLightFootprints)
 	{
+		if (layer <= LL_FIRE)
+		{
+			iterateTiles(
+				_save,
+				gsStatic,
+				[&](Tile* tile)
+				{
+					tile->resetLightMulti(layer);
+				}
+			);
+			unitsDirty.push_back(gsStatic);
+		}
+
 		iterateTiles(
 			_save,
-			gsStatic,
+			gsDynamic,
 			[&](Tile* tile)
 			{
-				tile->resetLightMulti(layer);
+				tile->resetLightMulti(std::max(layer, LL_ITEMS));
 			}
 		);
+		unitsDirty.push_back(gsDynamic);
 	}
 
-	iterateTiles(
-		_save,
-		gsDynamic,
-		[&](Tile* tile)
-		{
-			tile->resetLightMulti(std::max(layer, LL_ITEMS));
-		}
-	);
-
 	if (layer <= LL_AMBIENT) calculateSunShading(gsStatic);
 	if (layer <= LL_FIRE) calculateTerrainBackground(gsStatic);
 	if (layer <= LL_ITEMS) calculateTerrainItems(gsDynamic);
-	if (layer <= LL_UNITS) calculateUnitLighting(gsDynamic);
+	if (layer <= LL_UNITS)
+	{
+		if (_unitLightFootprints)
+		{
+			updateUnitLighting(unitsDirty);
+		}
+		else
+		{
+			calculateUnitLighting(gsDynamic);
+		}
+	}
 }
 
 /**
@@ -681,8 +972,9 @@ void TileEngine::calculateLighting(LightLayers layer, Position position, int eve
  * @param layer Light is separated in 4 layers: Ambient, Tiles, Items, Units.
  * @param cone coneSize of cone of light, 1 means 45 degrees, 4 means 360 degrees
  * @param direction - cone direction.
+ * @param footprint If set, light is added to this footprint instead of tiles.
  */
-void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers layer, int coneSize, int direction)
+void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers layer, int coneSize, int direction, LightFootprint *footprint)
 {
 	if (power <= 0)
 	{
@@ -711,7 +1003,7 @@ void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers
 			const auto target = tile->getPosition();
 			const auto diff = target - center;
 			const auto distance = (int)Round(Position::distance(target.toVoxel(), center.toVoxel()) / Position::TileXY);
-			const auto targetLight = tile->getLightMulti(layer);
+			const auto targetLight = footprint ? footprint->at(target) : tile->getLightMulti(layer);
 			auto currLight = power - distance;
 
 			if (currLight <= targetLight)
@@ -743,7 +1035,14 @@ void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers
 
 			if (clasicLighting)
 			{
-				tile->addLight(currLight, layer);
+				if (footprint)
+				{
+					footprint->at(target) = std::max(footprint->at(target), (Uint8)currLight);
+				}
+				else
+				{
+					tile->addLight(currLight, layer);
+				}
 				return;
 			}
 
@@ -837,7 +1136,14 @@ void TileEngine::addLight(MapSubset gs, Position center, int power, LightLayers
 			currLight = (lightA + lightB) / 2;
 			if (currLight > targetLight)
 			{
-				tile->addLight(currLight, layer);
+				if (footprint)
+				{
+					footprint->at(target) = currLight;
+				}
+				else
+				{
+					tile->addLight(currLight, layer);
+				}
 			}
 		}
 	);
@@ -1087,6 +1393,11 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 		return;
 	}
 	Position posSelf = unit->getPosition();
+	if ((eventRadius == 0 || eventPos == invalid) && Options::fovIncrementalUpdates && updateTilesInFOV(unit, direction))
+	{
+		//Nothing changed since last full check, or only tiles behind changed terrain needed update.
+		return;
+	}
 	if (setupEventVisibilitySector(posSelf, eventPos, eventRadius))
 	{
 		//Asked to do a full check. Or unit within event. Should update all.
@@ -1097,6 +1408,29 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 	//Only recalculate bresenham lines to tiles that are at the event or further away.
 	const int distanceSqrMin = skipNarrowArcTest ? 0 : std::max(Position::distance2dSq(posSelf, eventPos) - eventRadius * eventRadius, 0);
 
+	revealTilesInFOV(unit, posSelf, direction, distanceSqrMin);
+
+	if (skipNarrowArcTest)
+	{
+		storeTilesInFOV(unit, direction);
+		++_fovFullUpdates;
+	}
+	else
+	{
+		//Tiles of this unit were updated only partially, next full check can't rely on them.
+		_fovCache.erase(unit->getId());
+	}
+}
+
+/**
+ * Tests all tiles within view cone for visibility and reveals tiles along every line of sight.
+ * @param unit Unit to check line of sight of.
+ * @param posSelf Position of the unit.
+ * @param direction View direction of the unit.
+ * @param distanceSqrMin Only tiles this far or further away are tested, the narrow arc set up by setupEventVisibilitySector is respected too.
+ */
+void TileEngine::revealTilesInFOV(BattleUnit *unit, Position posSelf, int direction, int distanceSqrMin)
+{
 	//Variables for finding the tiles to test based on the view direction.
 	Position posTest;
 	std::vector<Position> _trajectory;
@@ -1152,6 +1486,7 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 									Position poso = posSelf + Position(xo, yo, 0);
 									_trajectory.clear();
 									int tst = calculateLineTile(poso, posTest, _trajectory);
+									++_fovRaysCast;
 									if (tst > 127)
 									{
 										//Vision impacted something before reaching posTest. Throw away the impact point.
@@ -1186,6 +1521,156 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 	}
 }
 
+/**
+ * Gets height of unit eyes above floor of its tile, it decides from which level unit looks.
+ */
+static int getEyeHeight(BattleUnit *unit, Tile *tile)
+{
+	return unit->getHeight() + unit->getFloatHeight() - tile->getTerrainLevel();
+}
+
+/**
+ * Tries to bring visible tiles of a unit up to date without a full check.
+ * If the unit didn't move or turn since its last full check, only rays behind terrain
+ * changed since then (door opened, wall destroyed) are cast again, none if nothing changed in view range.
+ * @param unit Unit to check line of sight of.
+ * @param direction View direction of the unit.
+ * @return True if the visible tiles are up to date, false if full check is required.
+ */
+bool TileEngine::updateTilesInFOV(BattleUnit *unit, int direction)
+{
+	auto it = _fovCache.find(unit->getId());
+	if (it == _fovCache.end())
+	{
+		return false;
+	}
+	FieldOfViewCache &cache = it->second;
+	const Position posSelf = unit->getPosition();
+	const int size = unit->getArmor()->getSize();
+	if (cache.revision < _fovChangesBase ||
+		cache.position != posSelf ||
+		cache.direction != direction ||
+		cache.size != size ||
+		cache.eyeHeight != getEyeHeight(unit, _save->getTile(unit->getPosition())) ||
+		cache.visibleTiles != unit->getVisibleTiles()->size())
+	{
+		return false;
+	}
+
+	//Changed tiles that could have been seen, large units have eyes on all their tiles.
+	const int radius = 1 + size;
+	const int range = getMaxViewDistance() + radius;
+	std::vector<Position> changes;
+	for (size_t i = cache.revision - _fovChangesBase; i < _fovChanges.size(); ++i)
+	{
+		const int distanceSqr = Position::distance2dSq(posSelf, _fovChanges[i]);
+		if (distanceSqr <= radius * radius)
+		{
+			//Change right next to the unit, affects whole view.
+			return false;
+		}
+		if (distanceSqr <= range * range)
+		{
+			changes.push_back(_fovChanges[i]);
+		}
+	}
+	if (changes.size() > FieldOfViewMaxUnitChanges)
+	{
+		return false;
+	}
+
+	if (changes.empty())
+	{
+		++_fovSkippedUpdates;
+	}
+	else
+	{
+		std::vector<Tile*> hidden;
+		for (std::vector<Position>::const_iterator i = changes.begin(); i != changes.end(); ++i)
+		{
+			setupEventVisibilitySector(posSelf, *i, radius);
+			const int distanceSqrMin = std::max(Position::distance2dSq(posSelf, *i) - radius * radius, 0);
+
+			//Forget tiles behind the change, these still in sight are revealed again.
+			hidden.clear();
+			for (std::vector<Tile*>::const_iterator t = unit->getVisibleTiles()->begin(); t != unit->getVisibleTiles()->end(); ++t)
+			{
+				const Position posTile = (*t)->getPosition();
+				if (Position::distance2dSq(posSelf, posTile) >= distanceSqrMin && inEventVisibilitySector(posTile))
+				{
+					hidden.push_back(*t);
+				}
+			}
+			for (std::vector<Tile*>::const_iterator t = hidden.begin(); t != hidden.end(); ++t)
+			{
+				unit->removeFromVisibleTiles(*t);
+			}
+			revealTilesInFOV(unit, posSelf, direction, distanceSqrMin);
+		}
+		++_fovPartialUpdates;
+	}
+	storeTilesInFOV(unit, direction);
+	return true;
+}
+
+/**
+ * Remembers state of the unit after its visible tiles were fully calculated.
+ * @param unit Unit to check line of sight of.
+ * @param direction View direction of the unit.
+ */
+void TileEngine::storeTilesInFOV(BattleUnit *unit, int direction)
+{
+	FieldOfViewCache &cache = _fovCache[unit->getId()];
+	cache.position = unit->getPosition();
+	cache.direction = direction;
+	cache.eyeHeight = getEyeHeight(unit, _save->getTile(unit->getPosition()));
+	cache.size = unit->getArmor()->getSize();
+	cache.visibleTiles = unit->getVisibleTiles()->size();
+	cache.revision = _fovChangesBase + (Uint32)_fovChanges.size();
+}
+
+/**
+ * Records tiles which changed how they block line of sight,
+ * visible tiles of units are updated only behind them.
+ * @param changes Positions of changed tiles.
+ */
+void TileEngine::addFieldOfViewChanges(const std::vector<Position> &changes)
+{
+	if (_fovChanges.size() + changes.size() > FieldOfViewMaxChanges)
+	{
+		//Too much changed, every unit needs full check.
+		_fovChangesBase += (Uint32)_fovChanges.size() + 1;
+		_fovChanges.clear();
+		return;
+	}
+	_fovChanges.insert(_fovChanges.end(), changes.begin(), changes.end());
+}
+
+/**
+ * Logs how many rays were cast for tile visibility during the turn and how many full checks were avoided.
+ */
+void TileEngine::endTurnFOV()
+{
+	if (_fovFullUpdates + _fovPartialUpdates + _fovSkippedUpdates > 0)
+	{
+		Log(LOG_DEBUG) << "Tile visibility: " << _fovRaysCast << " rays cast, " << _fovFullUpdates << " full, "
+			<< _fovPartialUpdates << " partial, " << _fovSkippedUpdates << " skipped updates";
+	}
+	_fovRaysCast = 0;
+	_fovFullUpdates = 0;
+	_fovPartialUpdates = 0;
+	_fovSkippedUpdates = 0;
+
+	if (_reactionChecks > 0)
+	{
+		Log(LOG_DEBUG) << "Reaction fire: " << _reactionChecks << " checks, " << _reactionCandidatesChecked << " candidates examined of "
+			<< _reactionUnitsTotal << " units (" << (double)_reactionCandidatesChecked / _reactionChecks << " per step)";
+	}
+	_reactionChecks = 0;
+	_reactionCandidatesChecked = 0;
+	_reactionUnitsTotal = 0;
+}
+
 /**
 * Recalculates line of sight of a soldier.
 * @param unit Unit to check line of sight of.
@@ -1195,6 +1680,7 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 */
 bool TileEngine::calculateFOV(BattleUnit *unit, bool doTileRecalc, bool doUnitRecalc)
 {
+	BattleSimulation::PhaseTimer timer(SP_FOV);
 	//Force a full FOV recheck for this unit.
 	if (doTileRecalc) calculateTilesInFOV(unit);
 	return doUnitRecalc ? calculateUnitsInFOV(unit) : false;
@@ -1581,8 +2067,6 @@ bool TileEngine::isTileInLOS(BattleAction *action, Tile *tile)
 int TileEngine::checkVoxelExposure(Position *originVoxel, Tile *tile, BattleUnit *excludeUnit, BattleUnit *excludeAllBut)
 {
 	Position targetVoxel = tile->getPosition().toVoxel() + Position(7, 8, 0);
-	Position scanVoxel;
-	std::vector<Position> _trajectory;
 	BattleUnit *otherUnit = tile->getUnit();
 	if (otherUnit == 0) return 0; //no unit in this tile, even if it elevated and appearing in it.
 	if (otherUnit == excludeUnit) return 0; //skip self
@@ -1621,26 +2105,29 @@ int TileEngine::checkVoxelExposure(Position *originVoxel, Tile *tile, BattleUnit
 	// scan ray from top to bottom  plus different parts of target cylinder
 	int total=0;
 	int visible=0;
+	std::vector<Position> scanVoxels;
 	for (int i = heightRange; i >=0; i-=2)
 	{
 		++total;
-		scanVoxel.z=targetMinHeight+i;
 		for (int j = 0; j < 3; ++j)
 		{
-			scanVoxel.x=targetVoxel.x + sliceTargets[j*2];
-			scanVoxel.y=targetVoxel.y + sliceTargets[j*2+1];
-			_trajectory.clear();
-			int test = calculateLineVoxel(*originVoxel, scanVoxel, false, &_trajectory, excludeUnit, excludeAllBut);
-			if (test == V_UNIT)
+			scanVoxels.push_back(Position(targetVoxel.x + sliceTargets[j*2], targetVoxel.y + sliceTargets[j*2+1], targetMinHeight+i));
+		}
+	}
+	std::vector<VoxelType> tests;
+	std::vector<Position> impacts;
+	calculateLinesVoxel(*originVoxel, scanVoxels, tests, impacts, excludeUnit, excludeAllBut);
+	for (size_t n = 0; n < scanVoxels.size(); ++n)
+	{
+		if (tests[n] == V_UNIT)
+		{
+			//voxel of hit must be inside of scanned box
+			if (impacts[n].x/16 == scanVoxels[n].x/16 &&
+				impacts[n].y/16 == scanVoxels[n].y/16 &&
+				impacts[n].z >= targetMinHeight &&
+				impacts[n].z <= targetMaxHeight)
 			{
-				//voxel of hit must be inside of scanned box
-				if (_trajectory.at(0).x/16 == scanVoxel.x/16 &&
-					_trajectory.at(0).y/16 == scanVoxel.y/16 &&
-					_trajectory.at(0).z >= targetMinHeight &&
-					_trajectory.at(0).z <= targetMaxHeight)
-				{
-					++visible;
-				}
+				++visible;
 			}
 		}
 	}
@@ -1660,8 +2147,6 @@ int TileEngine::checkVoxelExposure(Position *originVoxel, Tile *tile, BattleUnit
 bool TileEngine::canTargetUnit(Position *originVoxel, Tile *tile, Position *scanVoxel, BattleUnit *excludeUnit, bool rememberObstacles, BattleUnit *potentialUnit)
 {
 	Position targetVoxel = tile->getPosition().toVoxel() + Position(7, 8, 0);
-	std::vector<Position> _trajectory;
-	bool hypothetical = potentialUnit != 0;
 	if (potentialUnit == 0)
 	{
 		potentialUnit = tile->getUnit();
@@ -1709,17 +2194,23 @@ bool TileEngine::canTargetUnit(Position *originVoxel, Tile *tile, Position *scan
 	if (heightRange>10) heightRange=10;
 	if (heightRange<=0) heightRange=0;
 
-	// scan ray from top to bottom  plus different parts of target cylinder
+	// scan ray from top to bottom  plus different parts of target cylinder, rays of one height are traced together
+	std::vector<Position> scanVoxels;
+	std::vector<VoxelType> tests;
+	std::vector<Position> impacts;
 	for (int i = 0; i <= heightRange; ++i)
 	{
-		scanVoxel->z=targetCenterHeight+heightFromCenter[i];
+		scanVoxels.clear();
 		for (int j = 0; j < 5; ++j)
 		{
 			if (i < (heightRange-1) && j>2) break; //skip unnecessary checks
-			scanVoxel->x=targetVoxel.x + sliceTargets[j*2];
-			scanVoxel->y=targetVoxel.y + sliceTargets[j*2+1];
-			_trajectory.clear();
-			int test = calculateLineVoxel(*originVoxel, *scanVoxel, false, &_trajectory, excludeUnit);
+			scanVoxels.push_back(Position(targetVoxel.x + sliceTargets[j*2], targetVoxel.y + sliceTargets[j*2+1], targetCenterHeight+heightFromCenter[i]));
+		}
+		calculateLinesVoxel(*originVoxel, scanVoxels, tests, impacts, excludeUnit);
+		for (size_t n = 0; n < scanVoxels.size(); ++n)
+		{
+			*scanVoxel = scanVoxels[n];
+			int test = tests[n];
 			if (test == V_UNIT)
 			{
 				for (int x = 0; x <= targetSize; ++x)
@@ -1727,23 +2218,19 @@ bool TileEngine::canTargetUnit(Position *originVoxel, Tile *tile, Position *scan
 					for (int y = 0; y <= targetSize; ++y)
 					{
 						//voxel of hit must be inside of scanned box
-						if (_trajectory.at(0).x/16 == (scanVoxel->x/16) + x + xOffset &&
-							_trajectory.at(0).y/16 == (scanVoxel->y/16) + y + yOffset &&
-							_trajectory.at(0).z >= targetMinHeight &&
-							_trajectory.at(0).z <= targetMaxHeight)
+						if (impacts[n].x/16 == (scanVoxel->x/16) + x + xOffset &&
+							impacts[n].y/16 == (scanVoxel->y/16) + y + yOffset &&
+							impacts[n].z >= targetMinHeight &&
+							impacts[n].z <= targetMaxHeight)
 						{
 							return true;
 						}
 					}
 				}
 			}
-			else if (test == V_EMPTY && hypothetical && !_trajectory.empty())
-			{
-				return true;
-			}
-			if (rememberObstacles && _trajectory.size()>0)
+			if (rememberObstacles && test != V_EMPTY)
 			{
-				Tile *tileObstacle = _save->getTile(_trajectory.at(0).toTile());
+				Tile *tileObstacle = _save->getTile(impacts[n].toTile());
 				if (tileObstacle) tileObstacle->setObstacle(test);
 			}
 		}
@@ -1770,7 +2257,6 @@ bool TileEngine::canTargetTile(Position *originVoxel, Tile *tile, int part, Posi
 	static int northWallSpiral[14] = {7,0, 9,0, 6,0, 11,0, 4,0, 13,0, 2,0};
 
 	Position targetVoxel = Position((tile->getPosition().x * 16), (tile->getPosition().y * 16), tile->getPosition().z * 24);
-	std::vector<Position> _trajectory;
 
 	int *spiralArray;
 	int spiralCount;
@@ -1896,27 +2382,34 @@ bool TileEngine::canTargetTile(Position *originVoxel, Tile *tile, int part, Posi
 	if (rangeZ>10) rangeZ = 10; //as above, clamping height range to prevent buffer overflow
 	int centerZ = (maxZ + minZ)/2;
 
+	// rays of one height are traced together
+	std::vector<Position> scanVoxels;
+	std::vector<VoxelType> tests;
+	std::vector<Position> impacts;
 	for (int j = 0; j <= rangeZ; ++j)
 	{
-		scanVoxel->z = targetVoxel.z + centerZ + heightFromCenter[j];
+		scanVoxels.clear();
 		for (int i = 0; i < spiralCount; ++i)
 		{
-			scanVoxel->x = targetVoxel.x + spiralArray[i*2];
-			scanVoxel->y = targetVoxel.y + spiralArray[i*2+1];
-			_trajectory.clear();
-			int test = calculateLineVoxel(*originVoxel, *scanVoxel, false, &_trajectory, excludeUnit);
+			scanVoxels.push_back(Position(targetVoxel.x + spiralArray[i*2], targetVoxel.y + spiralArray[i*2+1], targetVoxel.z + centerZ + heightFromCenter[j]));
+		}
+		calculateLinesVoxel(*originVoxel, scanVoxels, tests, impacts, excludeUnit);
+		for (size_t n = 0; n < scanVoxels.size(); ++n)
+		{
+			*scanVoxel = scanVoxels[n];
+			int test = tests[n];
 			if (test == part && !dummy) //bingo
 			{
-				if (_trajectory.at(0).x/16 == scanVoxel->x/16 &&
-					_trajectory.at(0).y/16 == scanVoxel->y/16 &&
-					_trajectory.at(0).z/24 == scanVoxel->z/24)
+				if (impacts[n].x/16 == scanVoxel->x/16 &&
+					impacts[n].y/16 == scanVoxel->y/16 &&
+					impacts[n].z/24 == scanVoxel->z/24)
 				{
 					return true;
 				}
 			}
-			if (rememberObstacles && _trajectory.size()>0)
+			if (rememberObstacles && test != V_EMPTY)
 			{
-				Tile *tileObstacle = _save->getTile(_trajectory.at(0).toTile());
+				Tile *tileObstacle = _save->getTile(impacts[n].toTile());
 				if (tileObstacle) tileObstacle->setObstacle(test);
 			}
 		}
@@ -1934,6 +2427,7 @@ bool TileEngine::canTargetTile(Position *originVoxel, Tile *tile, int part, Posi
  */
 void TileEngine::calculateFOV(Position position, int eventRadius, const bool updateTiles, const bool appendToTileVisibility)
 {
+	BattleSimulation::PhaseTimer timer(SP_FOV);
 	int updateRadius;
 	if (eventRadius == -1)
 	{
@@ -2007,6 +2501,7 @@ void TileEngine::checkForSuspiciousItems(BattleUnit* unit)
  */
 bool TileEngine::checkReactionFire(BattleUnit *unit, const BattleAction &originalAction)
 {
+	BattleSimulation::PhaseTimer timer(SP_REACTION_FIRE);
 	if (_save->isPreview())
 	{
 		return false;
@@ -2069,7 +2564,14 @@ std::vector<TileEngine::ReactionScore> TileEngine::getSpottingUnits(BattleUnit*
 	// no reaction on civilian turn.
 	if (_save->getSide() != FACTION_NEUTRAL || _save->getGeoscapeSave()->isFtAGame())
 	{
-		for (std::vector<BattleUnit*>::const_iterator i = _save->getUnits()->begin(); i != _save->getUnits()->end(); ++i)
+		// only units standing close enough can see this unit, one tile more as position of walking unit can be ahead of its tile
+		std::vector<BattleUnit*> candidates;
+		_save->getUnitsInRange(unit->getPosition(), getMaxViewDistance() + 1, candidates);
+		_reactionChecks += 1;
+		_reactionCandidatesChecked += candidates.size();
+		_reactionUnitsTotal += _save->getUnits()->size();
+
+		for (std::vector<BattleUnit*>::const_iterator i = candidates.begin(); i != candidates.end(); ++i)
 		{
 				// not dead/unconscious
 			if (!(*i)->isOut() &&
@@ -2819,7 +3321,6 @@ void TileEngine::explode(BattleActionAttack attack, Position center, int power,
 	const Position centetTile = center.toTile();
 	int hitSide = 0;
 	int diagonalWall = 0;
-	int power_;
 	std::map<Tile*, int> tilesAffected;
 	std::vector<BattleItem*> toRemove;
 	std::pair<std::map<Tile*, int>::iterator, bool> ret;
@@ -2845,7 +3346,6 @@ void TileEngine::explode(BattleActionAttack attack, Position center, int power,
 	}
 
 	Tile *origin = _save->getTile(Position(centetTile));
-	Tile *dest = nullptr;
 	if (origin->isBigWall()) //pre-calculations for bigwall deflection
 	{
 		diagonalWall = origin->getMapData(O_OBJECT)->getBigWall();
@@ -2855,138 +3355,161 @@ void TileEngine::explode(BattleActionAttack attack, Position center, int power,
 			hitSide = (center.x % 16 + center.y % 16 - 15) > 0 ? 1 : -1;
 	}
 
-	for (int fi = -90; fi <= 90; fi += 5)
+	// raytrace every 5 degrees vertically and 3 degrees horizontally makes sure we cover all tiles in a circle.
+	// Rays only read terrain, so they are traced first (on worker threads if possible),
+	// then damage is applied in the original ray order, giving the same results (and RNG use) as tracing them one by one.
+	const int raysFi = 180 / 5 + 1;
+	const int raysTe = 360 / 3 + 1;
+	std::vector<std::vector<ExplosionStep>> rays(raysFi * raysTe);
+	auto traceRay = [&](size_t n)
 	{
-		// raytrace every 3 degrees makes sure we cover all tiles in a circle.
-		for (int te = 0; te <= 360; te += 3)
+		const int fi = -90 + (int)(n / raysTe) * 5;
+		const int te = (int)(n % raysTe) * 3;
+		std::vector<ExplosionStep> &steps = rays[n];
+
+		double cos_te = cos(Deg2Rad(te));
+		double sin_te = sin(Deg2Rad(te));
+		double sin_fi = sin(Deg2Rad(fi));
+		double cos_fi = cos(Deg2Rad(fi));
+
+		Tile *rayOrigin = origin;
+		Tile *rayDest = rayOrigin;
+		double l = 0;
+		int tileX, tileY, tileZ;
+		int rayPower = power;
+		while (rayPower > 0 && l <= maxRadius)
 		{
-			double cos_te = cos(Deg2Rad(te));
-			double sin_te = sin(Deg2Rad(te));
-			double sin_fi = sin(Deg2Rad(fi));
-			double cos_fi = cos(Deg2Rad(fi));
+			steps.push_back({ rayDest, rayPower });
+
+			l += 1.0;
+
+			tileX = int(floor(centetTile.x + 0.5 + l * sin_te * cos_fi));
+			tileY = int(floor(centetTile.y + 0.5 + l * cos_te * cos_fi));
+			tileZ = int(floor(centetTile.z + 0.5 + l * sin_fi));
+
+			rayOrigin = rayDest;
+			rayDest = _save->getTile(Position(tileX, tileY, tileZ));
+
+			if (!rayDest) break; // out of map!
 
-			origin = _save->getTile(centetTile);
-			dest = origin;
-			double l = 0;
-			int tileX, tileY, tileZ;
-			power_ = power;
-			while (power_ > 0 && l <= maxRadius)
+			// blockage by terrain is deducted from the explosion power
+			rayPower -= type->RadiusReduction; // explosive damage decreases by 10 per tile
+			if (rayOrigin->getPosition().z != tileZ)
+				rayPower -= vertdec; //3d explosion factor
+
+			if (type->FireBlastCalc)
 			{
-				if (power_ > 0)
+				int dir;
+				Pathfinding::vectorToDirection(rayOrigin->getPosition() - rayDest->getPosition(), dir);
+				if (dir != -1 && dir %2) rayPower -= 0.5f * type->RadiusReduction; // diagonal movement costs an extra 50% for fire.
+			}
+			if (l > 0.5) {
+				if ( l > 1.5)
 				{
-					ret = tilesAffected.insert(std::make_pair(dest, 0)); // check if we had this tile already affected
-
-					const int tileDmg = type->getTileFinalDamage(power_);
-					if (tileDmg > ret.first->second)
+					rayPower -= verticalBlockage(rayOrigin, rayDest, type->ResistType, false) * 2;
+					rayPower -= horizontalBlockage(rayOrigin, rayDest, type->ResistType, false) * 2;
+				}
+				else //tricky bigwall deflection /Volutar
+				{
+					bool skipObject = diagonalWall == 0;
+					if (diagonalWall == Pathfinding::BIGWALLNESW) // --
 					{
-						ret.first->second = tileDmg;
+						if (hitSide<0 && te >= 135 && te < 315)
+							skipObject = true;
+						if (hitSide>0 && ( te < 135 || te > 315))
+							skipObject = true;
 					}
-					if (ret.second)
+					if (diagonalWall == Pathfinding::BIGWALLNWSE) // |
 					{
-						const int damage = type->getRandomDamage(power_);
-						BattleUnit *bu = dest->getOverlappingUnit(_save);
-
-						toRemove.clear();
-						if (bu)
-						{
-							if (
-									(
-										Position::distance2dSq(dest->getPosition(), centetTile) < 4
-										&& dest->getPosition().z == centetTile.z
-									)
-									|| dest->getPosition().z > centetTile.z
-								)
-							{
-								// ground zero effect is in effect, or unit is above explosion
-								hitUnit(attack, bu, Position(0, 0, 0), damage, type, rangeAtack);
-							}
-							else
-							{
-								// directional damage relative to explosion position.
-								// units above the explosion will be hit in the legs, units lateral to or below will be hit in the torso
-								hitUnit(attack, bu, centetTile + Position(0, 0, 5) - dest->getPosition(), damage, type, rangeAtack);
-							}
-
-							// Affect all items and units in inventory
-							const int itemDamage = bu->getOverKillDamage();
-							if (itemDamage > 0)
-							{
-								for (std::vector<BattleItem*>::iterator it = bu->getInventory()->begin(); it != bu->getInventory()->end(); ++it)
-								{
-									if (!hitUnit(attack, (*it)->getUnit(), Position(0, 0, 0), itemDamage, type, rangeAtack) && type->getItemFinalDamage(itemDamage) > (*it)->getRules()->getArmor())
-									{
-										toRemove.push_back(*it);
-									}
-								}
-							}
-						}
-						// Affect all items and units on ground
-						for (std::vector<BattleItem*>::iterator it = dest->getInventory()->begin(); it != dest->getInventory()->end(); ++it)
-						{
-							if (!hitUnit(attack, (*it)->getUnit(), Position(0, 0, 0), damage, type) && type->getItemFinalDamage(damage) > (*it)->getRules()->getArmor())
-							{
-								toRemove.push_back(*it);
-							}
-						}
-						for (std::vector<BattleItem*>::iterator it = toRemove.begin(); it != toRemove.end(); ++it)
-						{
-							_save->removeItem((*it));
-						}
-
-						hitTile(dest, damage, type);
+						if (hitSide>0 && te >= 45 && te < 225)
+							skipObject = true;
+						if (hitSide<0 && ( te < 45 || te > 225))
+							skipObject = true;
 					}
-				}
+					rayPower -= verticalBlockage(rayOrigin, rayDest, type->ResistType, skipObject) * 2;
+					rayPower -= horizontalBlockage(rayOrigin, rayDest, type->ResistType, skipObject) * 2;
 
-				l += 1.0;
-
-				tileX = int(floor(centetTile.x + 0.5 + l * sin_te * cos_fi));
-				tileY = int(floor(centetTile.y + 0.5 + l * cos_te * cos_fi));
-				tileZ = int(floor(centetTile.z + 0.5 + l * sin_fi));
-
-				origin = dest;
-				dest = _save->getTile(Position(tileX, tileY, tileZ));
+				}
+			}
+		}
+	};
+	ThreadPool *pool = _save->getBattleGame() ? _save->getBattleGame()->getThreadPool() : nullptr;
+	if (pool)
+	{
+		pool->parallelFor(rays.size(), traceRay);
+	}
+	else
+	{
+		for (size_t n = 0; n < rays.size(); ++n)
+		{
+			traceRay(n);
+		}
+	}
 
-				if (!dest) break; // out of map!
+	for (const auto &steps : rays)
+	{
+		for (const ExplosionStep &step : steps)
+		{
+			ret = tilesAffected.insert(std::make_pair(step.tile, 0)); // check if we had this tile already affected
 
-				// blockage by terrain is deducted from the explosion power
-				power_ -= type->RadiusReduction; // explosive damage decreases by 10 per tile
-				if (origin->getPosition().z != tileZ)
-					power_ -= vertdec; //3d explosion factor
+			const int tileDmg = type->getTileFinalDamage(step.power);
+			if (tileDmg > ret.first->second)
+			{
+				ret.first->second = tileDmg;
+			}
+			if (ret.second)
+			{
+				const int damage = type->getRandomDamage(step.power);
+				BattleUnit *bu = step.tile->getOverlappingUnit(_save);
 
-				if (type->FireBlastCalc)
+				toRemove.clear();
+				if (bu)
 				{
-					int dir;
-					Pathfinding::vectorToDirection(origin->getPosition() - dest->getPosition(), dir);
-					if (dir != -1 && dir %2) power_ -= 0.5f * type->RadiusReduction; // diagonal movement costs an extra 50% for fire.
-				}
-				if (l > 0.5) {
-					if ( l > 1.5)
+					if (
+							(
+								Position::distance2dSq(step.tile->getPosition(), centetTile) < 4
+								&& step.tile->getPosition().z == centetTile.z
+							)
+							|| step.tile->getPosition().z > centetTile.z
+						)
 					{
-						power_ -= verticalBlockage(origin, dest, type->ResistType, false) * 2;
-						power_ -= horizontalBlockage(origin, dest, type->ResistType, false) * 2;
+						// ground zero effect is in effect, or unit is above explosion
+						hitUnit(attack, bu, Position(0, 0, 0), damage, type, rangeAtack);
 					}
-					else //tricky bigwall deflection /Volutar
+					else
 					{
-						bool skipObject = diagonalWall == 0;
-						if (diagonalWall == Pathfinding::BIGWALLNESW) // --
-						{
-							if (hitSide<0 && te >= 135 && te < 315)
-								skipObject = true;
-							if (hitSide>0 && ( te < 135 || te > 315))
-								skipObject = true;
-						}
-						if (diagonalWall == Pathfinding::BIGWALLNWSE) // |
+						// directional damage relative to explosion position.
+						// units above the explosion will be hit in the legs, units lateral to or below will be hit in the torso
+						hitUnit(attack, bu, centetTile + Position(0, 0, 5) - step.tile->getPosition(), damage, type, rangeAtack);
+					}
+
+					// Affect all items and units in inventory
+					const int itemDamage = bu->getOverKillDamage();
+					if (itemDamage > 0)
+					{
+						for (std::vector<BattleItem*>::iterator it = bu->getInventory()->begin(); it != bu->getInventory()->end(); ++it)
 						{
-							if (hitSide>0 && te >= 45 && te < 225)
-								skipObject = true;
-							if (hitSide<0 && ( te < 45 || te > 225))
-								skipObject = true;
+							if (!hitUnit(attack, (*it)->getUnit(), Position(0, 0, 0), itemDamage, type, rangeAtack) && type->getItemFinalDamage(itemDamage) > (*it)->getRules()->getArmor())
+							{
+								toRemove.push_back(*it);
+							}
 						}
-						power_ -= verticalBlockage(origin, dest, type->ResistType, skipObject) * 2;
-						power_ -= horizontalBlockage(origin, dest, type->ResistType, skipObject) * 2;
-
 					}
 				}
+				// Affect all items and units on ground
+				for (std::vector<BattleItem*>::iterator it = step.tile->getInventory()->begin(); it != step.tile->getInventory()->end(); ++it)
+				{
+					if (!hitUnit(attack, (*it)->getUnit(), Position(0, 0, 0), damage, type) && type->getItemFinalDamage(damage) > (*it)->getRules()->getArmor())
+					{
+						toRemove.push_back(*it);
+					}
+				}
+				for (std::vector<BattleItem*>::iterator it = toRemove.begin(); it != toRemove.end(); ++it)
+				{
+					_save->removeItem((*it));
+				}
+
+				hitTile(step.tile, damage, type);
 			}
 		}
 	}
@@ -3890,6 +4413,74 @@ VoxelType TileEngine::calculateLineVoxel(Position origin, Position target, bool
 	return V_EMPTY;
 }
 
+/**
+ * Calculates line trajectories of many rays from the same origin, with the same results as
+ * calculateLineVoxel for each of them, but rays are stepped together in batches.
+ * @param origin Origin in voxel.
+ * @param targets Targets of rays in voxel.
+ * @param results Returned objectnumber(0-3) or unit(4) or out of map (5) or -1(hit nothing) of every ray.
+ * @param impacts Returned position of impact of every ray, valid only if it hit something.
+ * @param excludeUnit Excludes this unit in the collision detection.
+ * @param excludeAllBut [Optional] The only unit to be considered for ray hits.
+ */
+void TileEngine::calculateLinesVoxel(Position origin, const std::vector<Position> &targets, std::vector<VoxelType> &results, std::vector<Position> &impacts, BattleUnit *excludeUnit, BattleUnit *excludeAllBut)
+{
+	// don't start unit spotting before pre-game inventory stuff, see calculateLineVoxel
+	bool excludeAllUnits = _save->isBeforeGame();
+
+	results.assign(targets.size(), V_EMPTY);
+	impacts.assign(targets.size(), invalid);
+
+	LineBatch batch;
+	Uint8 active[LineBatch::MaxLines];
+	for (size_t first = 0; first < targets.size(); first += LineBatch::MaxLines)
+	{
+		const int count = (int)std::min(targets.size() - first, (size_t)LineBatch::MaxLines);
+		for (int l = 0; l < count; ++l)
+		{
+			batch.setup(l, origin, targets[first + l]);
+			active[l] = 1;
+		}
+
+		int remaining = count;
+		while (remaining > 0)
+		{
+			batch.step(count);
+			for (int l = 0; l < count; ++l)
+			{
+				if (!active[l])
+				{
+					continue;
+				}
+				for (int p = 0; p < 3; ++p)
+				{
+					if (!batch.pointValid[p][l])
+					{
+						continue;
+					}
+					Position point = Position(batch.pointX[p][l], batch.pointY[p][l], batch.pointZ[p][l]);
+					VoxelType result = voxelCheck(point, excludeUnit, excludeAllUnits, false, excludeAllBut);
+					if (result != V_EMPTY)
+					{
+						results[first + l] = result;
+						impacts[first + l] = point;
+						active[l] = 0;
+						break;
+					}
+				}
+				if (active[l] && batch.last[l])
+				{
+					active[l] = 0;
+				}
+				if (!active[l])
+				{
+					--remaining;
+				}
+			}
+		}
+	}
+}
+
 /**
  * Calculates a parabola trajectory, used for throwing items.
  * @param origin Origin in voxelspace.
@@ -4017,10 +4608,11 @@ VoxelType TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool e
 	}
 	Position pos = voxel.toTile();
 	Tile *tile, *tileBelow;
-	if (_cacheTilePos == pos)
+	VoxelCheckCache &cache = voxelCheckCache;
+	if (cache.pos == pos && cache.engine == this)
 	{
-		tile = _cacheTile;
-		tileBelow = _cacheTileBelow;
+		tile = cache.tile;
+		tileBelow = cache.tileBelow;
 	}
 	else
 	{
@@ -4030,9 +4622,10 @@ VoxelType TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool e
 			return V_OUTOFBOUNDS; //not even cache
 		}
 		tileBelow = _save->getBelowTile(tile);
-		_cacheTilePos = pos;
-		_cacheTile = tile;
-		_cacheTileBelow = tileBelow;
+		cache.engine = this;
+		cache.pos = pos;
+		cache.tile = tile;
+		cache.tileBelow = tileBelow;
  	}
 
 	if (tile->isVoid() && tile->getUnit() == 0 && (!tileBelow || tileBelow->getUnit() == 0))
@@ -4049,17 +4642,14 @@ VoxelType TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool e
 	}
 
 	// first we check terrain voxel data, not to allow 2x2 units stick through walls
+	const Uint16 *lofts = _save->getTerrainVoxels(_save->getTileIndex(pos), (voxel.z%24)/2);
 	for (int i = V_FLOOR; i <= V_OBJECT; ++i)
 	{
-		TilePart tp = (TilePart)i;
-		MapData *mp = tile->getMapData(tp);
-		if (((tp == O_WESTWALL) || (tp == O_NORTHWALL)) && tile->isUfoDoorOpen(tp))
-			continue;
-		if (mp != 0)
+		if (lofts[i] != SavedBattleGame::NoTerrainVoxels)
 		{
 			int x = 15 - voxel.x%16;
 			int y = voxel.y%16;
-			int idx = (mp->getLoftID((voxel.z%24)/2)*16) + y;
+			int idx = (lofts[i]*16) + y;
 			if (_voxelData->at(idx) & (1 << x))
 			{
 				return (VoxelType)i;
@@ -4111,9 +4701,7 @@ VoxelType TileEngine::voxelCheck(Position voxel, BattleUnit *excludeUnit, bool e
 
 void TileEngine::voxelCheckFlush()
 {
-	_cacheTilePos = invalid;
-	_cacheTile = 0;
-	_cacheTileBelow = 0;
+	voxelCheckCache = VoxelCheckCache();
 }
 
 /**
@@ -4142,6 +4730,54 @@ void TileEngine::togglePersonalLighting()
 	recalculateFOV();
 }
 
+/**
+ * Measures how long it takes to update lighting after every lit unit moves,
+ * once recalculating all unit lights around it and once replacing only its footprint.
+ * Results are written to the log.
+ * @param iterations How many times every unit is updated.
+ * @return Short summary for the debug message.
+ */
+std::string TileEngine::benchmarkLighting(int iterations)
+{
+	const bool oldUnitLightFootprints = _unitLightFootprints;
+	std::vector<LightEmitter> emitters;
+	std::vector<BattleUnit*> lit;
+	for (BattleUnit *unit : *_save->getUnits())
+	{
+		getUnitLightEmitters(unit, emitters);
+		if (!emitters.empty())
+		{
+			lit.push_back(unit);
+		}
+	}
+
+	std::ostringstream context;
+	context << "map " << _save->getMapSizeX() << "x" << _save->getMapSizeY() << "x" << _save->getMapSizeZ() << ", " << lit.size() << " unit light sources";
+	Benchmark benchmark("Lighting", context.str());
+	for (int mode = 0; mode < 2; ++mode)
+	{
+		_unitLightFootprints = (mode == 1);
+		calculateLighting(LL_UNITS);
+		double ms = Benchmark::time([&]
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				for (BattleUnit *unit : lit)
+				{
+					// same work as moving the unit, without moving it
+					_unitLights.erase(unit->getId());
+					calculateLighting(LL_UNITS, unit->getPosition(), 2);
+				}
+			}
+		});
+		benchmark.add(_unitLightFootprints ? "footprints" : "full", ms, iterations * lit.size(), "update");
+	}
+
+	_unitLightFootprints = oldUnitLightFootprints;
+	calculateLighting(LL_UNITS);
+	return benchmark.getSummary();
+}
+
 /**
  * Calculate strength of psi attack based on range and victim.
  * @param type Type of attack.
@@ -5211,6 +5847,7 @@ bool TileEngine::validateThrow(BattleAction &action, Position originVoxel, Posit
  */
 void TileEngine::recalculateFOV()
 {
+	BattleSimulation::PhaseTimer timer(SP_FOV);
 	for (std::vector<BattleUnit*>::iterator bu = _save->getUnits()->begin(); bu != _save->getUnits()->end(); ++bu)
 	{
 		if ((*bu)->getTile() != 0)
@@ -18,8 +18,10 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <vector>
+#include <unordered_map>
 #include "Position.h"
 #include "BattlescapeGame.h"
+#include "../Engine/GraphSubset.h"
 #include "../Mod/RuleItem.h"
 #include "../Mod/MapData.h"
 
@@ -32,7 +34,6 @@ class BattleItem;
 class Tile;
 class RuleSkill;
 struct BattleAction;
-template<typename Tag, typename DataType> struct AreaSubset;
 
 enum UnitBodyPart : int;
 
@@ -72,6 +73,52 @@ private:
 		Uint8 height;
 	};
 
+	/**
+	 * Helper class storing unit state from the last full calculation of its visible tiles.
+	 */
+	struct FieldOfViewCache
+	{
+		Position position;
+		int direction;
+		int eyeHeight;
+		int size;
+		size_t visibleTiles;
+		Uint32 revision;
+	};
+
+	/**
+	 * Helper class storing parameters of one light cast by a unit.
+	 */
+	struct LightEmitter
+	{
+		Position center;
+		int power;
+		int coneSize;
+		int direction;
+
+		bool operator==(const LightEmitter &other) const
+		{
+			return center == other.center && power == other.power && coneSize == other.coneSize && direction == other.direction;
+		}
+	};
+
+	/**
+	 * Helper class storing light added to the map by one unit, so it can be removed or moved without recalculating other lights.
+	 */
+	struct LightFootprint
+	{
+		std::vector<LightEmitter> emitters;
+		MapSubset area;
+		std::vector<Uint8> light;
+		Uint32 update;
+
+		/// Gets light of the footprint at position within its area.
+		Uint8 &at(Position pos)
+		{
+			return light[(pos.z * area.size_y() + pos.y - area.beg_y) * area.size_x() + pos.x - area.beg_x];
+		}
+	};
+
 	/**
 	 * Helper class storing reaction data.
 	 */
@@ -91,9 +138,9 @@ private:
 	RuleInventory *_inventorySlotGround;
 	constexpr static int heightFromCenter[11] = {0,-2,+2,-4,+4,-6,+6,-8,+8,-12,+12};
 	bool _personalLighting;
-	Tile *_cacheTile;
-	Tile *_cacheTileBelow;
-	Position _cacheTilePos;
+	bool _unitLightFootprints;
+	std::unordered_map<int, LightFootprint> _unitLights;
+	Uint32 _unitLightUpdate;
 	const int _maxViewDistance;        // 20 tiles by default
 	const int _maxViewDistanceSq;      // 20 * 20
 	const int _maxVoxelViewDistance;   // maxViewDistance * 16
@@ -102,11 +149,17 @@ private:
 	const int _maxDynamicLightDistance;
 	const int _enhancedLighting;
 	Position _eventVisibilitySectorL, _eventVisibilitySectorR, _eventVisibilityObserverPos;
+	std::unordered_map<int, FieldOfViewCache> _fovCache;
+	std::vector<Position> _fovChanges;
+	Uint32 _fovChangesBase;
+	Uint32 _fovRaysCast, _fovFullUpdates, _fovPartialUpdates, _fovSkippedUpdates;
+	Uint32 _reactionChecks;
+	Uint64 _reactionCandidatesChecked, _reactionUnitsTotal;
 	std::vector<BattleUnit*> _movingUnitPrev;
 	BattleUnit* _movingUnit = nullptr;
 
 	/// Add light source.
-	void addLight(MapSubset gs, Position center, int power, LightLayers layer, int coneSize = 0, int direction = 0);
+	void addLight(MapSubset gs, Position center, int power, LightLayers layer, int coneSize = 0, int direction = 0, LightFootprint *footprint = nullptr);
 	/// Calculate blockage amount.
 	int blockage(Tile *tile, const TilePart part, ItemDamageType type, int direction = -1, bool checkingFromOrigin = false);
 	/// Get max distance that fire light can reach.
@@ -126,6 +179,14 @@ private:
 
 	bool setupEventVisibilitySector(const Position &observerPos, const Position &eventPos, const int &eventRadius);
 	inline bool inEventVisibilitySector(const Position &toCheck) const;
+	/// Casts rays to all tiles in view cone (or event sector) and reveals tiles along them.
+	void revealTilesInFOV(BattleUnit *unit, Position posSelf, int direction, int distanceSqrMin);
+	/// Updates visible tiles of a unit only behind terrain changed since its last calculation.
+	bool updateTilesInFOV(BattleUnit *unit, int direction);
+	/// Remembers state of unit after full calculation of its visible tiles.
+	void storeTilesInFOV(BattleUnit *unit, int direction);
+	/// Records tiles that changed visibility blocking.
+	void addFieldOfViewChanges(const std::vector<Position> &changes);
 
 	/// Calculates sun shading of the whole map.
 	void calculateSunShading(MapSubset gs);
@@ -135,6 +196,10 @@ private:
 	void calculateTerrainItems(MapSubset gs);
 	/// Recalculates lighting of the battlescape for units.
 	void calculateUnitLighting(MapSubset gs);
+	/// Gets lights cast by a unit.
+	void getUnitLightEmitters(BattleUnit *unit, std::vector<LightEmitter> &emitters);
+	/// Updates lighting of units, recalculating only lights of units that changed.
+	void updateUnitLighting(std::vector<MapSubset> &dirty);
 
 	/// Checks validity of a snap shot to this position.
 	ReactionScore determineReactionType(BattleUnit *unit, BattleUnit *target);
@@ -160,12 +225,12 @@ public:
 	/// Calculates the field of view within range of a certain position.
 	void calculateFOV(Position position, int eventRadius = -1, const bool updateTiles = true, const bool appendToTileVisibility = false);
 	void checkForSuspiciousItems(BattleUnit* unit);
+	/// Logs field of view and reaction fire statistics and starts new turn.
+	void endTurnFOV();
 	/// Checks reaction fire.
 	bool checkReactionFire(BattleUnit *unit, const BattleAction &originalAction);
 	/// Recalculate all lighting in some area.
 	void calculateLighting(LightLayers layer, Position position = invalid, int eventRadius = 0, bool terrianChanged = false);
-	/// Adds unit directional lighting
-	void calculateUnitDirectionalLighting(MapSubset gs, BattleUnit *unit, const BattleItem *w);
 	/// Handles tile hit.
 	int hitTile(Tile *tile, int damage, const RuleDamageType* type);
 	/// Handles experience training.
@@ -186,6 +251,8 @@ public:
 	int calculateLineTile(Position origin, Position target, std::vector<Position> &trajectory);
 	/// Calculates a line trajectory in voxel space.
 	VoxelType calculateLineVoxel(Position origin, Position target, bool storeTrajectory, std::vector<Position> *trajectory, BattleUnit *excludeUnit, BattleUnit *excludeAllBut = 0, bool onlyVisible = false);
+	/// Calculates line trajectories of many rays from one origin together, stopping each at its first hit.
+	void calculateLinesVoxel(Position origin, const std::vector<Position> &targets, std::vector<VoxelType> &results, std::vector<Position> &impacts, BattleUnit *excludeUnit, BattleUnit *excludeAllBut = 0);
 	/// Calculates a parabola trajectory.
 	int calculateParabolaVoxel(Position origin, Position target, bool storeTrajectory, std::vector<Position> *trajectory, BattleUnit *excludeUnit, double curvature, const Position delta);
 	/// Gets the origin voxel of a unit's eyesight.
@@ -198,6 +265,8 @@ public:
 	bool isTileInLOS(BattleAction *action, Tile *tile);
 	/// Turn XCom soldier's personal lighting on or off.
 	void togglePersonalLighting();
+	/// Measures recalculation of unit lights, full versus footprint based.
+	std::string benchmarkLighting(int iterations);
 	/// Checks the horizontal blockage of a tile.
 	int horizontalBlockage(Tile *startTile, Tile *endTile, ItemDamageType type, bool skipObject = false);
 	/// Checks the vertical blockage of a tile.
@@ -256,7 +325,7 @@ public:
 	bool isVoxelVisible(Position voxel);
 	/// Checks what type of voxel occupies this space.
 	VoxelType voxelCheck(Position voxel, BattleUnit *excludeUnit, bool excludeAllUnits = false, bool onlyVisible = false, BattleUnit *excludeAllBut = 0);
-	/// Flushes cache of voxel check
+	/// Flushes cache of voxel check of the calling thread.
 	void voxelCheckFlush();
 	/// Blows this tile up.
 	bool detonate(Tile* tile, int power);
@@ -17,6 +17,7 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "UnitSprite.h"
+#include "SpriteVariantCache.h"
 #include "../Engine/SurfaceSet.h"
 #include "../Mod/RuleItem.h"
 #include "../Mod/Armor.h"
@@ -37,8 +38,9 @@ namespace OpenXcom
  * @param height Height in pixels.
  * @param x X position in pixels.
  * @param y Y position in pixels.
+ * @param spriteCache Cache of recolored sprites, can be null.
  */
-UnitSprite::UnitSprite(Surface* dest, const Mod* mod, const SavedBattleGame* save, int frame, bool helmet) :
+UnitSprite::UnitSprite(Surface* dest, const Mod* mod, const SavedBattleGame* save, int frame, bool helmet, SpriteVariantCache* spriteCache) :
 	_unit(0), _itemR(0), _itemL(0),
 	_unitSurface(0),
 	_itemSurface(const_cast<Mod*>(mod)->getSurfaceSet("HANDOB.PCK")),
@@ -46,7 +48,7 @@ UnitSprite::UnitSprite(Surface* dest, const Mod* mod, const SavedBattleGame* sav
 	_breathSurface(const_cast<Mod*>(mod)->getSurfaceSet("BREATH-1.PCK", false)),
 	_facingArrowSurface(const_cast<Mod*>(mod)->getSurfaceSet("DETBLOB.DAT")),
 	_warnIndicator(const_cast<Mod*>(mod)->getSurface("UnitWarnedIndicator", false)),
-	_dest(dest), _save(save), _mod(mod),
+	_dest(dest), _save(save), _mod(mod), _spriteCache(spriteCache),
 	_part(0), _animationFrame(frame), _drawingRoutine(0),
 	_helmet(helmet),
 	_x(0), _y(0), _shade(0), _burn(0),
@@ -144,8 +146,16 @@ void UnitSprite::blitItem(Part& item)
 	{
 		return;
 	}
+	const BattleItem *battleItem = (item.bodyPart == BODYPART_ITEM_RIGHTHAND ? _itemR : _itemL);
 	ScriptWorkerBlit work;
-	BattleItem::ScriptFill(&work, (item.bodyPart == BODYPART_ITEM_RIGHTHAND ? _itemR : _itemL), _save, item.bodyPart, _animationFrame, _shade);
+	BattleItem::ScriptFill(&work, battleItem, _save, item.bodyPart, _animationFrame, _shade);
+
+	// default item script only shades, without own script the item would be recolored like its unit
+	if (_spriteCache && work.isDefault() && battleItem->getRules()->getScript<ModScript::RecolorItemSprite>())
+	{
+		blitCached(work, item, {}, 0);
+		return;
+	}
 
 	_dest->lock();
 
@@ -167,6 +177,12 @@ void UnitSprite::blitBody(Part& body)
 	ScriptWorkerBlit work;
 	BattleUnit::ScriptFill(&work, _unit, _save, body.bodyPart, _animationFrame, _shade, _burn);
 
+	if (_spriteCache && work.isDefault())
+	{
+		blitCached(work, body, _unit->getRecolor(), _burn);
+		return;
+	}
+
 	_dest->lock();
 
 	work.executeBlit(body.src, _dest,  _x + body.offX, _y + body.offY, _shade, _mask);
@@ -174,6 +190,36 @@ void UnitSprite::blitBody(Part& body)
 	_dest->unlock();
 }
 
+/**
+ * Blit sprite recolored by a default script. Its result depends only on the sprite,
+ * unit recolor, burn and shade, so the script is run once for every variant
+ * and later frames copy it from the cache. Map parts drawn on other threads
+ * share the cache, a missing variant is recolored and copied outside its lock.
+ * @param work Script worker with default script.
+ * @param part Sprite to blit.
+ * @param recolor Unit recolor used by the script.
+ * @param burn Burn used by the script.
+ */
+void UnitSprite::blitCached(ScriptWorkerBlit& work, Part& part, const std::vector<std::pair<Uint8, Uint8> >& recolor, int burn)
+{
+	std::shared_ptr<const Surface> variant = _spriteCache->get(part.src, recolor, burn, _shade);
+	if (!variant)
+	{
+		auto newVariant = std::make_shared<Surface>(part.src->getWidth(), part.src->getHeight());
+		newVariant->lock();
+		work.executeBlit(part.src, newVariant.get(), 0, 0, _shade);
+		newVariant->unlock();
+		_spriteCache->add(part.src, recolor, burn, _shade, newVariant);
+		variant = std::move(newVariant);
+	}
+
+	_dest->lock();
+
+	variant->blitNShade(_dest, _x + part.offX, _y + part.offY, 0, _mask);
+
+	_dest->unlock();
+}
+
 /**
  * Draws a unit, using the drawing rules of the unit.
  * This function is called by Map, for each unit on the screen.
@@ -27,6 +27,7 @@ class BattleUnit;
 class BattleItem;
 class SavedBattleGame;
 class SurfaceSet;
+class SpriteVariantCache;
 class Mod;
 
 /**
@@ -55,6 +56,7 @@ private:
 	Surface* _warnIndicator, *_dest;
 	const SavedBattleGame *_save;
 	const Mod *_mod;
+	SpriteVariantCache *_spriteCache;
 	int _part, _animationFrame, _drawingRoutine;
 	bool _helmet;
 	int _x, _y, _shade, _burn;
@@ -106,9 +108,11 @@ private:
 	void blitItem(Part& item);
 	/// Blit body sprite.
 	void blitBody(Part& body);
+	/// Blit sprite recolored by default script, drawing it only once.
+	void blitCached(ScriptWorkerBlit& work, Part& part, const std::vector<std::pair<Uint8, Uint8> >& recolor, int burn);
 public:
 	/// Creates a new UnitSprite at the specified position and size.
-	UnitSprite(Surface* dest, const Mod* mod, const SavedBattleGame* save, int frame, bool helmet);
+	UnitSprite(Surface* dest, const Mod* mod, const SavedBattleGame* save, int frame, bool helmet, SpriteVariantCache* spriteCache = nullptr);
 	/// Cleans up the UnitSprite.
 	~UnitSprite();
 	/// Draws the unit.
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Benchmark.h"
+#include "Logger.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Creates a benchmark.
+ * @param name Name of the benchmark, like `Lighting`.
+ * @param context What it runs on, like map size and number of units.
+ */
+Benchmark::Benchmark(const std::string &name, const std::string &context) : _name(name), _context(context), _modes(0)
+{
+
+}
+
+/**
+ * Writes result of one mode to the log and adds time per unit of work to the summary.
+ * @param mode Name of the mode.
+ * @param ms Time taken by the mode, in milliseconds.
+ * @param count How many units of work were done.
+ * @param unit Name of the unit of work, like `frame`.
+ * @param details Anything else to log about the mode.
+ */
+void Benchmark::add(const std::string &mode, double ms, size_t count, const std::string &unit, const std::string &details)
+{
+	double perUnit = count > 0 ? ms / count : 0.0;
+	Log(LOG_INFO) << _name << " benchmark (" << mode << ", " << _context << "): " << count << " " << unit << "s in " << ms << " ms, "
+		<< perUnit << " ms per " << unit << details;
+	_summary << (_modes++ ? ", " : "") << mode << ": " << perUnit << " ms";
+}
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <sstream>
+#include <string>
+
+namespace OpenXcom
+{
+
+/**
+ * Debug benchmark comparing modes of doing the same work.
+ * Every mode is timed by the caller with `time`, then `add` writes it
+ * to the log and to a short summary for the debug message.
+ */
+class Benchmark
+{
+	std::string _name, _context;
+	std::ostringstream _summary;
+	int _modes;
+public:
+	/// Creates a benchmark, context describes the data it runs on.
+	Benchmark(const std::string &name, const std::string &context);
+	/// Runs work once and returns how long it took, in milliseconds.
+	template<typename F>
+	static double time(F &&work)
+	{
+		auto start = std::chrono::steady_clock::now();
+		work();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+	/// Logs result of one mode.
+	void add(const std::string &mode, double ms, size_t count, const std::string &unit, const std::string &details = "");
+	/// Gets short summary of all modes.
+	std::string getSummary() const { return _summary.str(); }
+};
+
+}
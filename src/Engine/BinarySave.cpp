@@ -0,0 +1,369 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BinarySave.h"
+#include <cstring>
+#include <memory>
+#include <SDL.h>
+#include "YamlBinary.h"
+#include "CrossPlatform.h"
+#include "Exception.h"
+#include "Logger.h"
+#include "../../libs/miniz/miniz.h"
+
+namespace OpenXcom
+{
+
+namespace BinarySave
+{
+
+namespace
+{
+
+/// Can't be mistaken for the start of a YAML text file.
+const unsigned char Signature[] = { 0x89, 'O', 'X', 'C', 'E', 'S', 'A', 'V' };
+
+/// Bump when layout of binary save or YamlBinary changes, older versions must stay loadable.
+const size_t FormatVersion = 1;
+
+/// Enough for brief info of nearly every save, the rest is read only when needed.
+const size_t HeaderChunk = 4096;
+
+/// Closes a file when leaving the scope, also when reading it throws.
+struct RWopsCloser
+{
+	void operator()(SDL_RWops *rwops) const { SDL_RWclose(rwops); }
+};
+using RWopsPtr = std::unique_ptr<SDL_RWops, RWopsCloser>;
+
+/**
+ * Skips signature and version.
+ * @param pos Start of data, moved after the version.
+ * @param end End of data.
+ */
+void readPreamble(const unsigned char *&pos, const unsigned char *end)
+{
+	if (!isBinary(pos, end - pos))
+	{
+		throw Exception("Not a binary save");
+	}
+	pos += sizeof(Signature);
+	size_t version = YamlBinary::readSize(pos, end);
+	if (version == 0 || version > FormatVersion)
+	{
+		throw Exception("Unsupported binary save version " + std::to_string(version));
+	}
+}
+
+}
+
+/**
+ * Checks if data starts with the binary save signature.
+ * @param data Start of file content.
+ * @param size Number of available bytes.
+ * @return True for binary save.
+ */
+bool isBinary(const unsigned char *data, size_t size)
+{
+	return size >= sizeof(Signature) && std::memcmp(data, Signature, sizeof(Signature)) == 0;
+}
+
+/**
+ * Encodes the brief info and the game data.
+ * @param brief Brief info shown in the save list.
+ * @param game Full game data.
+ * @return Encoded documents.
+ */
+Snapshot snapshot(const YAML::Node &brief, const YAML::Node &game)
+{
+	Snapshot result;
+	YamlBinary::write(result.brief, brief);
+	YamlBinary::write(result.game, game);
+	return result;
+}
+
+/**
+ * Builds a binary save from the brief info and the game data.
+ * @param buffer Output buffer.
+ * @param brief Brief info shown in the save list.
+ * @param game Full game data.
+ */
+void write(std::vector<unsigned char> &buffer, const YAML::Node &brief, const YAML::Node &game)
+{
+	write(buffer, snapshot(brief, game));
+}
+
+/**
+ * Builds a binary save from a snapshot.
+ * @param buffer Output buffer.
+ * @param snapshot Encoded documents.
+ */
+void write(std::vector<unsigned char> &buffer, const Snapshot &snapshot)
+{
+	buffer.insert(buffer.end(), Signature, Signature + sizeof(Signature));
+	YamlBinary::writeSize(buffer, FormatVersion);
+
+	YamlBinary::writeSize(buffer, snapshot.brief.size());
+	buffer.insert(buffer.end(), snapshot.brief.begin(), snapshot.brief.end());
+
+	const std::vector<unsigned char> &data = snapshot.game;
+	mz_ulong packedSize = mz_compressBound((mz_ulong)data.size());
+	std::vector<unsigned char> packed(packedSize);
+	if (mz_compress2(packed.data(), &packedSize, data.data(), (mz_ulong)data.size(), MZ_BEST_SPEED) != MZ_OK)
+	{
+		throw Exception("Failed to compress save data");
+	}
+	YamlBinary::writeSize(buffer, data.size());
+	YamlBinary::writeSize(buffer, packedSize);
+	buffer.insert(buffer.end(), packed.begin(), packed.begin() + packedSize);
+}
+
+/**
+ * Reads the brief info and the game data from a binary save.
+ * @param buffer Whole file content.
+ * @return Same documents as in a YAML save: brief info and game data.
+ */
+std::vector<YAML::Node> read(const std::vector<unsigned char> &buffer)
+{
+	const unsigned char *pos = buffer.data();
+	const unsigned char *end = pos + buffer.size();
+	readPreamble(pos, end);
+
+	std::vector<YAML::Node> docs;
+	size_t briefSize = YamlBinary::readSize(pos, end);
+	if ((size_t)(end - pos) < briefSize)
+	{
+		throw Exception("Corrupted binary save");
+	}
+	const unsigned char *briefEnd = pos + briefSize;
+	docs.push_back(YamlBinary::read(pos, briefEnd));
+
+	size_t size = YamlBinary::readSize(pos, end);
+	size_t packedSize = YamlBinary::readSize(pos, end);
+	// deflate can't pack better than about 1:1032
+	if ((size_t)(end - pos) != packedSize || size / 1032 > packedSize)
+	{
+		throw Exception("Corrupted binary save");
+	}
+	std::vector<unsigned char> data(size);
+	mz_ulong unpackedSize = (mz_ulong)size;
+	if (mz_uncompress(data.data(), &unpackedSize, pos, (mz_ulong)packedSize) != MZ_OK || unpackedSize != size)
+	{
+		throw Exception("Failed to decompress save data");
+	}
+	docs.push_back(YamlBinary::read(data));
+	return docs;
+}
+
+/**
+ * Builds a YAML save from the brief info and the game data.
+ * @param brief Brief info shown in the save list.
+ * @param game Full game data.
+ * @return YAML text with two documents.
+ */
+std::string writeYaml(const YAML::Node &brief, const YAML::Node &game)
+{
+	YAML::Emitter out;
+	out << brief;
+	out << YAML::BeginDoc;
+	out << game;
+	return out.c_str();
+}
+
+/**
+ * Builds a YAML save from a snapshot.
+ * @param snapshot Encoded documents.
+ * @return YAML text with two documents.
+ */
+std::string writeYaml(const Snapshot &snapshot)
+{
+	return writeYaml(YamlBinary::read(snapshot.brief), YamlBinary::read(snapshot.game));
+}
+
+/**
+ * Loads all documents of a save file in either format.
+ * @param filename Full path of the save.
+ * @return Brief info and game data.
+ */
+std::vector<YAML::Node> loadFile(const std::string &filename)
+{
+	std::vector<unsigned char> data;
+	if (!CrossPlatform::readFile(filename, data))
+	{
+		throw Exception("Failed to read " + filename);
+	}
+	if (isBinary(data.data(), data.size()))
+	{
+		return read(data);
+	}
+	return YAML::LoadAll(std::string(data.begin(), data.end()));
+}
+
+/**
+ * Loads only the brief info of a save file in either format,
+ * without reading the whole game data.
+ * Doesn't log anything, so it can run on a worker thread.
+ * @param filename Full path of the save.
+ * @return Brief info.
+ */
+YAML::Node loadHeader(const std::string &filename)
+{
+	RWopsPtr file(SDL_RWFromFile(filename.c_str(), "rb"));
+	SDL_RWops *rwops = file.get();
+	if (!rwops)
+	{
+		throw Exception("Failed to read " + filename + ": " + SDL_GetError());
+	}
+	std::vector<unsigned char> data(HeaderChunk);
+	data.resize(SDL_RWread(rwops, data.data(), 1, data.size()));
+	if (!isBinary(data.data(), data.size()))
+	{
+		// YAML header ends with the start of the second document
+		static const char separator[] = "\n---";
+		const size_t separatorSize = sizeof(separator) - 1;
+		std::string text(data.begin(), data.end());
+		size_t searchFrom = 0;
+		size_t end;
+		while ((end = text.find(separator, searchFrom)) == std::string::npos)
+		{
+			size_t read = text.size();
+			text.resize(read + HeaderChunk);
+			size_t count = SDL_RWread(rwops, &text[read], 1, HeaderChunk);
+			text.resize(read + count);
+			if (count == 0)
+			{
+				end = text.size();
+				break;
+			}
+			searchFrom = read >= separatorSize ? read - separatorSize : 0;
+		}
+		text.resize(end);
+		return YAML::Load(text);
+	}
+
+	const unsigned char *pos = data.data();
+	readPreamble(pos, data.data() + data.size());
+	size_t briefSize = YamlBinary::readSize(pos, data.data() + data.size());
+	size_t offset = pos - data.data();
+	if (offset + briefSize > data.size())
+	{
+		// size comes from the file, check it before allocating anything
+		size_t read = data.size();
+		Sint64 fileSize = SDL_RWseek(rwops, 0, RW_SEEK_END);
+		if (fileSize < 0 || briefSize > (size_t)fileSize - offset || SDL_RWseek(rwops, read, RW_SEEK_SET) < 0)
+		{
+			throw Exception("Corrupted binary save " + filename);
+		}
+		data.resize(offset + briefSize);
+		if (SDL_RWread(rwops, data.data() + read, 1, data.size() - read) != data.size() - read)
+		{
+			throw Exception("Corrupted binary save " + filename);
+		}
+	}
+	file.reset();
+
+	pos = data.data() + offset;
+	return YamlBinary::read(pos, pos + briefSize);
+}
+
+/**
+ * Writes a snapshot to a save file. The data goes to a temporary file first
+ * which then replaces the save, so a failed write never damages the old save.
+ * Doesn't log anything, so it can run on a worker thread (SDL file IO is thread safe).
+ * @param filename Full path of the save.
+ * @param snapshot Encoded documents.
+ * @param binary Use binary format instead of YAML.
+ * @return Size of the written file.
+ */
+size_t writeFile(const std::string &filename, const Snapshot &snapshot, bool binary)
+{
+	std::vector<unsigned char> data;
+	if (binary)
+	{
+		write(data, snapshot);
+	}
+	else
+	{
+		std::string text = writeYaml(snapshot);
+		data.assign(text.begin(), text.end());
+	}
+
+	std::string temp = filename + ".bak";
+	RWopsPtr file(SDL_RWFromFile(temp.c_str(), "wb"));
+	if (!file)
+	{
+		throw Exception("Failed to write " + temp + ": " + SDL_GetError());
+	}
+	if (1 != SDL_RWwrite(file.get(), data.data(), data.size(), 1))
+	{
+		throw Exception("Failed to write " + temp + ": " + SDL_GetError());
+	}
+	file.reset();
+	if (!CrossPlatform::moveFile(temp, filename))
+	{
+		throw Exception("Save backed up in " + CrossPlatform::baseFilename(temp));
+	}
+	return data.size();
+}
+
+/**
+ * Converts a save file to the other format in place,
+ * the original file is kept with ".bak" appended.
+ * @param filename Full path of the save.
+ */
+void convertFile(const std::string &filename)
+{
+	std::vector<unsigned char> data;
+	if (!CrossPlatform::readFile(filename, data))
+	{
+		throw Exception("Failed to read " + filename);
+	}
+	if (!CrossPlatform::writeFile(filename + ".bak", data))
+	{
+		throw Exception("Failed to back up " + filename);
+	}
+
+	bool ok;
+	if (isBinary(data.data(), data.size()))
+	{
+		std::vector<YAML::Node> docs = read(data);
+		std::string text = writeYaml(docs[0], docs[1]);
+		Log(LOG_INFO) << "Converting " << filename << " to YAML: " << data.size() << " -> " << text.size() << " bytes";
+		ok = CrossPlatform::writeFile(filename, text);
+	}
+	else
+	{
+		std::vector<YAML::Node> docs = YAML::LoadAll(std::string(data.begin(), data.end()));
+		if (docs.size() < 2)
+		{
+			throw Exception(filename + " is not a save file");
+		}
+		std::vector<unsigned char> binary;
+		write(binary, docs[0], docs[1]);
+		Log(LOG_INFO) << "Converting " << filename << " to binary: " << data.size() << " -> " << binary.size() << " bytes";
+		ok = CrossPlatform::writeFile(filename, binary);
+	}
+	if (!ok)
+	{
+		throw Exception("Failed to write " + filename);
+	}
+}
+
+}
+
+}
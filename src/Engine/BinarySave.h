@@ -0,0 +1,69 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+namespace OpenXcom
+{
+
+/**
+ * Binary savegame format, an alternative to the two YAML documents of a save file.
+ * The brief info is stored uncompressed right after the signature so the save list
+ * can read it cheaply, the game data follows compressed with miniz.
+ * Both parts use the YamlBinary node encoding, so loading code is shared with YAML saves.
+ */
+namespace BinarySave
+{
+	/**
+	 * Both save documents encoded by YamlBinary.
+	 * Doesn't share anything with the source nodes, so it can be handed to another thread.
+	 */
+	struct Snapshot
+	{
+		std::vector<unsigned char> brief, game;
+	};
+
+	/// Checks if data starts with the binary save signature.
+	bool isBinary(const unsigned char *data, size_t size);
+	/// Encodes the brief info and the game data.
+	Snapshot snapshot(const YAML::Node &brief, const YAML::Node &game);
+	/// Builds a binary save from the brief info and the game data.
+	void write(std::vector<unsigned char> &buffer, const YAML::Node &brief, const YAML::Node &game);
+	/// Builds a binary save from a snapshot.
+	void write(std::vector<unsigned char> &buffer, const Snapshot &snapshot);
+	/// Reads the brief info and the game data from a binary save.
+	std::vector<YAML::Node> read(const std::vector<unsigned char> &buffer);
+	/// Builds a YAML save from the brief info and the game data.
+	std::string writeYaml(const YAML::Node &brief, const YAML::Node &game);
+	/// Builds a YAML save from a snapshot.
+	std::string writeYaml(const Snapshot &snapshot);
+
+	/// Loads all documents of a save file in either format.
+	std::vector<YAML::Node> loadFile(const std::string &filename);
+	/// Loads only the brief info of a save file in either format.
+	YAML::Node loadHeader(const std::string &filename);
+	/// Writes a snapshot to a save file through a temporary file, can run on a worker thread.
+	size_t writeFile(const std::string &filename, const Snapshot &snapshot, bool binary);
+	/// Converts a save file to the other format in place.
+	void convertFile(const std::string &filename);
+}
+
+}
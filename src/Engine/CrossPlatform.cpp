@@ -882,6 +882,33 @@ time_t getDateModified(const std::string &path)
 #endif
 }
 
+/**
+ * Gets the size of a file.
+ * @param path Full path to file.
+ * @return The size in bytes, 0 if the file doesn't exist.
+ */
+uint64_t getFileSize(const std::string &path)
+{
+#ifdef _WIN32
+	auto pathW = pathToWindows(path);
+	WIN32_FILE_ATTRIBUTE_DATA info;
+	if (!GetFileAttributesExW(pathW.c_str(), GetFileExInfoStandard, &info)) {
+		return 0;
+	}
+	return ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+#else
+	struct stat info;
+	if (stat(path.c_str(), &info) == 0)
+	{
+		return info.st_size;
+	}
+	else
+	{
+		return 0;
+	}
+#endif
+}
+
 /**
  * Converts a date/time into a human-readable string
  * using the ISO 8601 standard.
@@ -1035,6 +1062,28 @@ std::unique_ptr<std::istream> readFile(const std::string& filename) {
 	return std::unique_ptr<std::istream>(new std::istringstream(datastr));
 }
 
+/**
+ * Reads a binary file.
+ * @param filename - what to readFile
+ * @param data - where to put file content
+ * @return if we did read it.
+ */
+bool readFile(const std::string& filename, std::vector<unsigned char>& data) {
+	SDL_RWops *rwops = SDL_RWFromFile(filename.c_str(), "rb");
+	if (!rwops) {
+		return false;
+	}
+	size_t size;
+	unsigned char *raw = (unsigned char *)SDL_LoadFile_RW(rwops, &size, SDL_TRUE);
+	if (raw == NULL) {
+		Log(LOG_ERROR) << "Failed to read " << filename << ": " << SDL_GetError();
+		return false;
+	}
+	data.assign(raw, raw + size);
+	SDL_free(raw);
+	return true;
+}
+
 /**
  * Gets an istream to a file's bytes at least up to and including first "\n---" sequence.
  * To be used only for savegames.
@@ -33,16 +33,22 @@
 #include "../Mod/Mod.h"
 #include "../Savegame/SavedGame.h"
 #include "../Savegame/SavedBattleGame.h"
+#include "../Savegame/SaveIndex.h"
 #include "../FTA/MasterMind.h"
 #include "Action.h"
 #include "Exception.h"
 #include "Options.h"
 #include "CrossPlatform.h"
 #include "FileMap.h"
+#include "SaveWriter.h"
 #include "Unicode.h"
+#include "Timer.h"
+#include "Script.h"
 #include "../Ufopaedia/UfopaediaStartState.h"
 #include "../Menu/NotesState.h"
 #include "../Menu/TestState.h"
+#include "../Battlescape/BattleSimulation.h"
+#include "../Geoscape/GeoscapeSimulation.h"
 #include <algorithm>
 #include "../fallthrough.h"
 
@@ -56,12 +62,20 @@ const double Game::VOLUME_GRADIENT = 10.0;
  * creates the display screen and sets up the cursor.
  * @param title Title of the game window.
  */
-Game::Game(const std::string &title) : _screen(0), _cursor(0), _lang(0), _save(0), _mod(0), _mind(0), _quit(false), _init(false), _update(false),  _mouseActive(true), _timeUntilNextFrame(0),
+Game::Game(const std::string &title) : _screen(0), _cursor(0), _lang(0), _save(0), _mod(0), _mind(0), _saveWriter(0), _saveIndex(0), _quit(false), _init(false), _update(false),  _mouseActive(true), _timeUntilNextFrame(0),
 	_ctrl(false), _alt(false), _shift(false), _rmb(false), _mmb(false)
 {
 	Options::reload = false;
 	Options::mute = false;
 
+	if (Options::isHeadless())
+	{
+		// battle simulation, nothing is shown or played
+		SDL_putenv(const_cast<char*>("SDL_VIDEODRIVER=dummy"));
+		Options::useOpenGL = false;
+		Timer::headless = true;
+	}
+
 	// Initialize SDL
 	if (SDL_Init(SDL_INIT_VIDEO) < 0)
 	{
@@ -72,7 +86,14 @@ Game::Game(const std::string &title) : _screen(0), _cursor(0), _lang(0), _save(0
 	Log(LOG_INFO) << "SDL initialized successfully.";
 
 	// Initialize SDL_mixer
-	initAudio();
+	if (Options::isHeadless())
+	{
+		Options::mute = true;
+	}
+	else
+	{
+		initAudio();
+	}
 
 	// trap the mouse inside the window
 	SDL_WM_GrabInput(Options::captureMouse);
@@ -107,6 +128,9 @@ Game::Game(const std::string &title) : _screen(0), _cursor(0), _lang(0), _save(0
 	_timeOfLastFrame = 0;
 
 	_mind = new MasterMind(this);
+
+	_saveWriter = new SaveWriter();
+	_saveIndex = new SaveIndex();
 }
 
 /**
@@ -117,11 +141,17 @@ Game::~Game()
 	Sound::stop();
 	Music::stop();
 
+	// finish any background save before the game data goes away
+	delete _saveWriter;
+	delete _saveIndex;
+
 	for (std::list<State*>::iterator i = _states.begin(); i != _states.end(); ++i)
 	{
 		delete *i;
 	}
 
+	ScriptProfiler::report();
+
 	SDL_FreeCursor(SDL_GetCursor());
 
 	delete _cursor;
@@ -167,6 +197,10 @@ void Game::run()
 		{
 			_init = true;
 			_states.back()->init();
+			if (GeoscapeSimulation::isRunning())
+			{
+				GeoscapeSimulation::stateActivated();
+			}
 
 			// Unpress buttons
 			_states.back()->resetAll();
@@ -182,6 +216,9 @@ void Game::run()
 			_states.back()->handle(&action);
 		}
 
+		// Report finished background saves
+		_saveWriter->poll();
+
 		// Process events
 		while (SDL_PollEvent(&_event))
 		{
@@ -306,6 +343,11 @@ void Game::run()
 								}
 							}
 						}
+						// "ctrl-alt-p" script profile
+						else if (action.getDetails()->key.keysym.sym == SDLK_p && isCtrlPressed() && isAltPressed() && Options::getProfileScripts())
+						{
+							ScriptProfiler::report();
+						}
 						else if (Options::debug)
 						{
 							if (action.getDetails()->key.keysym.sym == SDLK_t && isCtrlPressed())
@@ -331,12 +373,26 @@ void Game::run()
 			}
 		}
 
+		// Simulations play without input, dismiss any messages
+		if (_init && BattleSimulation::isRunning())
+		{
+			BattleSimulation::dismissMessages(_states.back());
+		}
+		else if (_init && GeoscapeSimulation::isRunning())
+		{
+			GeoscapeSimulation::dismissMessages(this, _states.back());
+		}
+
 		// Process rendering
 		if (runningState != PAUSED)
 		{
 			// Process logic
 			_states.back()->think();
 			_fpsCounter->think();
+			if (Options::isHeadless())
+			{
+				continue;
+			}
 			if (Options::FPS > 0 && !(Options::useOpenGL && Options::vSyncForOpenGL))
 			{
 				// Update our FPS delay time based on the time of the last draw.
@@ -383,7 +439,10 @@ void Game::run()
 		}
 	}
 
-	Options::save();
+	if (!Options::isHeadless())
+	{
+		Options::save();
+	}
 }
 
 /**
@@ -392,9 +451,10 @@ void Game::run()
 void Game::quit()
 {
 	// Always save ironman
-	if (_save != 0 && _save->isIronman() && !_save->getName().empty())
+	if (_save != 0 && _save->isIronman() && !Options::isHeadless() && !_save->getName().empty())
 	{
 		std::string filename = CrossPlatform::sanitizeFilename(_save->getName()) + ".sav";
+		_saveWriter->wait();
 		_save->save(filename, _mod);
 	}
 	_quit = true;
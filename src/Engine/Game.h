@@ -34,6 +34,8 @@ class MasterMind;
 class ModInfo;
 class FpsCounter;
 class Action;
+class SaveWriter;
+class SaveIndex;
 
 /**
  * The core of the game engine, manages the game's entire contents and structure.
@@ -52,6 +54,8 @@ private:
 	SavedGame *_save;
 	Mod *_mod;
 	MasterMind *_mind;
+	SaveWriter *_saveWriter;
+	SaveIndex *_saveIndex;
 	bool _quit, _init, _update;
 	FpsCounter *_fpsCounter;
 	bool _mouseActive;
@@ -91,6 +95,10 @@ public:
 	SavedGame *getSavedGame() const { return _save; }
 	/// Sets a new saved game for the game.
 	void setSavedGame(SavedGame *save);
+	/// Gets the background save writer.
+	SaveWriter *getSaveWriter() const { return _saveWriter; }
+	/// Gets the index of save file headers.
+	SaveIndex *getSaveIndex() const { return _saveIndex; }
 	/// Gets MasterMind for this game.
 	MasterMind* getMasterMind() const { return _mind; }
 	/// Gets the currently loaded mod.
@@ -31,6 +31,7 @@
 #include "Exception.h"
 #include "Logger.h"
 #include "CrossPlatform.h"
+#include "BinarySave.h"
 #include "../Menu/ModConfirmExtendedState.h"
 #include "FileMap.h"
 #include "Screen.h"
@@ -56,6 +57,13 @@ std::string _masterMod;
 int _passwordCheck = -1;
 bool _loadLastSave = false;
 bool _loadLastSaveExpended = false;
+std::string _convertSave;
+std::string _simulateBattle;
+int _simulateTurns = 10;
+std::string _simulateGeoscape;
+int _simulateDays = 30;
+bool _profileScripts = false;
+bool _benchmarkTargetGrid = false;
 
 /**
  * Sets up the options by creating their OptionInfo metadata.
@@ -270,6 +278,22 @@ void create()
 	_info.push_back(OptionInfo("oxceDisableAlienInventory", &oxceDisableAlienInventory, false, "", "HIDDEN"));
 	_info.push_back(OptionInfo("oxceDisableInventoryTuCost", &oxceDisableInventoryTuCost, false, "", "HIDDEN"));
 
+	// performance tuning, hidden
+	_info.push_back(OptionInfo("rulesetParseThreads", &rulesetParseThreads, 0));
+	_info.push_back(OptionInfo("rulesetLoadTimings", &rulesetLoadTimings, false));
+	_info.push_back(OptionInfo("rulesetCache", &rulesetCache, false));
+	_info.push_back(OptionInfo("saveBinary", &saveBinary, false));
+	_info.push_back(OptionInfo("autosaveInBackground", &autosaveInBackground, true));
+	_info.push_back(OptionInfo("pathfindingBucketQueue", &pathfindingBucketQueue, false));
+	_info.push_back(OptionInfo("pathfindingReachableCache", &pathfindingReachableCache, true));
+	_info.push_back(OptionInfo("battleThreads", &battleThreads, -1));
+	_info.push_back(OptionInfo("fovIncrementalUpdates", &fovIncrementalUpdates, true));
+	_info.push_back(OptionInfo("lightingUnitFootprints", &lightingUnitFootprints, true));
+	_info.push_back(OptionInfo("battleDirtyRects", &battleDirtyRects, true));
+	_info.push_back(OptionInfo("debugDirtyRects", &debugDirtyRects, false));
+	_info.push_back(OptionInfo("scriptFuseOps", &scriptFuseOps, true));
+	_info.push_back(OptionInfo("battleDrawThreads", &battleDrawThreads, 0));
+
 	// controls
 	_info.push_back(OptionInfo("keyOk", &keyOk, SDLK_RETURN, "STR_OK", "STR_GENERAL"));
 	_info.push_back(OptionInfo("keyCancel", &keyCancel, SDLK_ESCAPE, "STR_CANCEL", "STR_GENERAL"));
@@ -504,6 +528,16 @@ static void loadArgs()
 				_loadLastSave = true;
 				continue;
 			}
+			if (argname == "profilescripts")
+			{
+				_profileScripts = true;
+				continue;
+			}
+			if (argname == "benchmarktargetgrid")
+			{
+				_benchmarkTargetGrid = true;
+				continue;
+			}
 			if (argv.size() > i + 1)
 			{
 				++i; // we'll be consuming the next argument too
@@ -533,6 +567,26 @@ static void loadArgs()
 				{
 					_masterMod = argv[i];
 				}
+				else if (argname == "convertsave")
+				{
+					_convertSave = argv[i];
+				}
+				else if (argname == "simulatebattle")
+				{
+					_simulateBattle = argv[i];
+				}
+				else if (argname == "simulateturns")
+				{
+					_simulateTurns = std::max(1, atoi(argv[i].c_str()));
+				}
+				else if (argname == "simulategeoscape")
+				{
+					_simulateGeoscape = argv[i];
+				}
+				else if (argname == "simulatedays")
+				{
+					_simulateDays = std::max(1, atoi(argv[i].c_str()));
+				}
 				else
 				{
 					//save this command line option for now, we will apply it later
@@ -565,6 +619,25 @@ static bool showHelp()
 	help << "        use PATH as the default Config Folder instead of auto-detecting" << std::endl << std::endl;
 	help << "-master MOD" << std::endl;
 	help << "        set MOD to the current master mod (eg. -master xcom2)" << std::endl << std::endl;
+	help << "-convertSave FILE" << std::endl;
+	help << "        convert savegame FILE between YAML and binary format and quit," << std::endl;
+	help << "        the original is kept as FILE.bak" << std::endl << std::endl;
+	help << "-simulateBattle FILE" << std::endl;
+	help << "        play the battle in savegame FILE with AI on all sides, without" << std::endl;
+	help << "        rendering, then print time spent in each phase and quit" << std::endl << std::endl;
+	help << "-simulateTurns N" << std::endl;
+	help << "        number of turns to play with -simulateBattle (default 10)" << std::endl << std::endl;
+	help << "-simulateGeoscape FILE" << std::endl;
+	help << "        advance the campaign in savegame FILE as fast as possible, closing" << std::endl;
+	help << "        any popups, then print time spent in each time handler and quit" << std::endl << std::endl;
+	help << "-simulateDays N" << std::endl;
+	help << "        number of days to advance with -simulateGeoscape (default 30)" << std::endl << std::endl;
+	help << "-benchmarkTargetGrid" << std::endl;
+	help << "        with -simulateGeoscape, time the search for UFOs near the bases" << std::endl;
+	help << "        of the savegame with and without a target grid instead, then quit" << std::endl << std::endl;
+	help << "-profileScripts" << std::endl;
+	help << "        measure calls, operations and time of every mod script, the report" << std::endl;
+	help << "        is written to the log on exit or when pressing Ctrl-Alt-P" << std::endl << std::endl;
 	help << "-KEY VALUE" << std::endl;
 	help << "        override option KEY with VALUE (eg. -displayWidth 640)" << std::endl << std::endl;
 	help << "-help" << std::endl;
@@ -666,6 +739,19 @@ bool init()
 	Log(LOG_INFO) << "Config folder is: " << _configFolder;
 	Log(LOG_INFO) << "Options loaded successfully.";
 
+	if (!_convertSave.empty())
+	{
+		try
+		{
+			BinarySave::convertFile(_convertSave);
+		}
+		catch (std::exception &e)
+		{
+			Log(LOG_ERROR) << "Failed to convert " << _convertSave << ": " << e.what();
+		}
+		return false;
+	}
+
 	FileMap::clear(false, Options::oxceEmbeddedOnly);
 	return true;
 }
@@ -934,6 +1020,41 @@ void expendLoadLastSave()
 	_loadLastSaveExpended = true;
 }
 
+const std::string &getSimulateBattle()
+{
+	return _simulateBattle;
+}
+
+int getSimulateTurns()
+{
+	return _simulateTurns;
+}
+
+const std::string &getSimulateGeoscape()
+{
+	return _simulateGeoscape;
+}
+
+int getSimulateDays()
+{
+	return _simulateDays;
+}
+
+bool getProfileScripts()
+{
+	return _profileScripts;
+}
+
+bool getBenchmarkTargetGrid()
+{
+	return _benchmarkTargetGrid;
+}
+
+bool isHeadless()
+{
+	return !_simulateBattle.empty() || !_simulateGeoscape.empty();
+}
+
 /**
  * Sets up the game's Data folder where the data files
  * are loaded from and the User folder and Config
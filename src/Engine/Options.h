@@ -122,6 +122,20 @@ namespace Options
 	bool getLoadLastSave();
 	/// And do it only at startup
 	void expendLoadLastSave();
+	/// Gets the savegame to simulate a battle from, if any.
+	const std::string &getSimulateBattle();
+	/// Gets the number of turns to simulate.
+	int getSimulateTurns();
+	/// Gets the savegame to simulate a campaign from, if any.
+	const std::string &getSimulateGeoscape();
+	/// Gets the number of days to simulate.
+	int getSimulateDays();
+	/// Are mod scripts profiled?
+	bool getProfileScripts();
+	/// Is the target grid benchmarked instead of simulating the campaign?
+	bool getBenchmarkTargetGrid();
+	/// Is the game running without a display?
+	bool isHeadless();
 }
 
 }
@@ -121,6 +121,41 @@ OPT bool oxceDisableHitLog;
 OPT bool oxceDisableAlienInventory;
 OPT bool oxceDisableInventoryTuCost;
 
+// Performance tuning, hidden, accessible only via options.cfg
+/**
+ * Number of threads used for parsing ruleset files.
+ * 0 = parse on the loading thread, negative = use all cores.
+ */
+OPT int rulesetParseThreads;
+OPT bool rulesetLoadTimings;
+/// Reuse parsed rulesets from a binary cache (keyed by file content md5) in the master user folder.
+OPT bool rulesetCache;
+/// Write savegames in the compressed binary format instead of YAML, both formats are always loadable.
+OPT bool saveBinary;
+/// Write autosaves on a background thread, only the in-memory snapshot is taken on the game loop.
+OPT bool autosaveInBackground;
+/// Use a bucket queue (Dial's algorithm) instead of a binary heap for the pathfinding open set.
+OPT bool pathfindingBucketQueue;
+/// Reuse reachable tiles of AI units until a unit moves or terrain changes.
+OPT bool pathfindingReachableCache;
+/**
+ * Number of threads used in battle by AI to evaluate candidate positions (line of fire checks)
+ * and by explosions to trace rays. 0 or 1 = game thread only, negative = use all cores.
+ */
+OPT int battleThreads;
+/// Update visible tiles of units only behind changed terrain, skip update when unit didn't move or turn.
+OPT bool fovIncrementalUpdates;
+/// Keep light added by every unit, so moving a unit only replaces its own light instead of recalculating all unit lights around it.
+OPT bool lightingUnitFootprints;
+/// Redraw only the changed parts of the battlescape map while it waits for player input.
+OPT bool battleDirtyRects;
+/// Outline the parts of the battlescape map redrawn by battleDirtyRects.
+OPT bool debugDirtyRects;
+/// Merge the last operation of a script with its exit when possible (compare script speed with it off).
+OPT bool scriptFuseOps;
+/// Number of threads drawing horizontal bands of the battlescape map. 0 or 1 = game thread only, negative = use all cores.
+OPT int battleDrawThreads;
+
 // Flags and other stuff that don't need OptionInfo's.
 OPT bool mute, reload, newOpenGL, newScaleFilter, newHQXFilter, newXBRZFilter, newRootWindowedMode, newFullscreen, newAllowResize, newBorderless;
 OPT int newDisplayWidth, newDisplayHeight, newBattlescapeScale, newGeoscapeScale, newWindowedModePositionX, newWindowedModePositionY;
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SaveWriter.h"
+#include "ThreadPool.h"
+#include "Logger.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Creates the writer with its own worker thread.
+ */
+SaveWriter::SaveWriter() : _thread(std::make_unique<ThreadPool>(1))
+{
+}
+
+/**
+ * Makes sure the last save reaches the disk before the game quits.
+ */
+SaveWriter::~SaveWriter()
+{
+	wait();
+}
+
+/**
+ * Starts writing a snapshot to a save file, see BinarySave::writeFile.
+ * @param filename Full path of the save.
+ * @param snapshot Encoded save documents, owned by the writer from now.
+ * @param binary Use binary format instead of YAML.
+ */
+void SaveWriter::write(const std::string &filename, BinarySave::Snapshot &&snapshot, bool binary)
+{
+	wait();
+	_pendingName = filename;
+	_pendingStart = std::chrono::steady_clock::now();
+	auto data = std::make_shared<BinarySave::Snapshot>(std::move(snapshot));
+	_pending = _thread->submit([filename, data, binary]
+	{
+		return BinarySave::writeFile(filename, *data, binary);
+	});
+}
+
+/**
+ * Checks if the pending write has finished, without blocking.
+ */
+void SaveWriter::poll()
+{
+	if (_pending.valid() && _pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		finish();
+	}
+}
+
+/**
+ * Blocks until the pending write has finished.
+ */
+void SaveWriter::wait()
+{
+	if (_pending.valid())
+	{
+		finish();
+	}
+}
+
+/**
+ * Logs result of the finished write, errors are not fatal for the running game.
+ */
+void SaveWriter::finish()
+{
+	try
+	{
+		size_t size = _pending.get();
+		auto time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _pendingStart);
+		Log(LOG_INFO) << "Saved " << CrossPlatform::baseFilename(_pendingName) << " in background (" << size << " bytes): " << time.count() << " ms";
+	}
+	catch (std::exception &e)
+	{
+		Log(LOG_ERROR) << "Background save of " << _pendingName << " failed: " << e.what();
+	}
+}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include "BinarySave.h"
+
+namespace OpenXcom
+{
+
+class ThreadPool;
+
+/**
+ * Writes save snapshots to disk on a background thread,
+ * so autosaves don't stall the game loop with emitting, compression and file IO.
+ * Only one write is in flight at a time, a new one first waits for the previous.
+ */
+class SaveWriter
+{
+	std::unique_ptr<ThreadPool> _thread;
+	std::future<size_t> _pending;
+	std::string _pendingName;
+	std::chrono::steady_clock::time_point _pendingStart;
+
+	/// Logs result of the finished write.
+	void finish();
+public:
+	/// Creates the writer.
+	SaveWriter();
+	/// Waits for the pending write.
+	~SaveWriter();
+
+	SaveWriter(const SaveWriter&) = delete;
+	SaveWriter& operator=(const SaveWriter&) = delete;
+
+	/// Starts writing a snapshot to a save file.
+	void write(const std::string &filename, BinarySave::Snapshot &&snapshot, bool binary);
+	/// Checks if the pending write has finished.
+	void poll();
+	/// Blocks until the pending write has finished.
+	void wait();
+};
+
+}
@@ -24,6 +24,10 @@
 #include <cmath>
 #include <bitset>
 #include <array>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 #include "Logger.h"
 #include "Options.h"
@@ -65,6 +69,17 @@ namespace OpenXcom
 	MACRO_COPY_64(Func, (Pos) + 0x80) \
 	MACRO_COPY_64(Func, (Pos) + 0xC0)
 
+#define MACRO_HEX_16(Func, H) \
+	Func(H, 0) Func(H, 1) Func(H, 2) Func(H, 3) \
+	Func(H, 4) Func(H, 5) Func(H, 6) Func(H, 7) \
+	Func(H, 8) Func(H, 9) Func(H, A) Func(H, B) \
+	Func(H, C) Func(H, D) Func(H, E) Func(H, F)
+#define MACRO_HEX_256(Func) \
+	MACRO_HEX_16(Func, 0) MACRO_HEX_16(Func, 1) MACRO_HEX_16(Func, 2) MACRO_HEX_16(Func, 3) \
+	MACRO_HEX_16(Func, 4) MACRO_HEX_16(Func, 5) MACRO_HEX_16(Func, 6) MACRO_HEX_16(Func, 7) \
+	MACRO_HEX_16(Func, 8) MACRO_HEX_16(Func, 9) MACRO_HEX_16(Func, A) MACRO_HEX_16(Func, B) \
+	MACRO_HEX_16(Func, C) MACRO_HEX_16(Func, D) MACRO_HEX_16(Func, E) MACRO_HEX_16(Func, F)
+
 
 ////////////////////////////////////////////////////////////
 //						proc definition
@@ -229,6 +244,9 @@ static inline RetEnum bit_popcount_h(int& reg)
 	IMPL(set_shade,		MACRO_QUOTE({ Reg0 = (Reg0 & 0xF0) | (Data1 & 0xF);			return RetContinue; }),		(int& Reg0, int Data1),		"Set color part to pixel color in arg1") \
 	IMPL(add_shade,		MACRO_QUOTE({ addShade_h(Reg0, Data1);						return RetContinue; }),		(int& Reg0, int Data1),		"Add value of shade to pixel color in arg1") \
 	\
+	IMPL(set_exit,			MACRO_QUOTE({ Reg0 = Data1;									return RetEnd; }),		(ScriptWorkerBase& c, int& Reg0, int Data1),	"") \
+	IMPL(add_shade_exit,	MACRO_QUOTE({ addShade_h(Reg0, Data1);						return RetEnd; }),		(int& Reg0, int Data1),		"") \
+	\
 	IMPL(call,			MACRO_QUOTE({ return call_func_h(c, func, d, p);								}),		(ScriptFunc func, const Uint8* d, ScriptWorkerBase& c, ProgPos& p),		"") \
 
 
@@ -376,6 +394,14 @@ enum ProcEnum : Uint8
 
 #undef MACRO_CREATE_PROC_ENUM
 
+/**
+ * Operations created only by `ParserWriter::pushProcExit`, scripts can't use them by name.
+ */
+constexpr bool isInternalProc(ProcEnum proc)
+{
+	return proc == Proc_set_exit || proc == Proc_add_shade_exit;
+}
+
 ////////////////////////////////////////////////////////////
 //					core loop function
 ////////////////////////////////////////////////////////////
@@ -383,18 +409,20 @@ enum ProcEnum : Uint8
 /**
  * Core function in script engine used to executing scripts
  * @param proc array storing operation of script
+ * @param opCount number of executed operations is added there, when CountOps is set
  * @return Result of executing script
  */
-static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
+template<bool CountOps = false>
+static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc, Uint64* opCount = nullptr)
 {
 	ProgPos curr = ProgPos::Start;
 	//--------------------------------------------------
 	//			helper macros for this function
 	//--------------------------------------------------
 	#define MACRO_FUNC_ARRAY(NAME, ...) + helper::FuncGroup<MACRO_FUNC_ID(NAME)>::FuncList{}
-	#define MACRO_FUNC_ARRAY_LOOP(POS) \
-		case (POS): \
+	#define MACRO_FUNC_ARRAY_BODY(POS) \
 		{ \
+			if (CountOps) ++*opCount; \
 			using currType = helper::GetType<func, POS>; \
 			const auto p = proc + (int)curr; \
 			curr += currType::offset; \
@@ -409,13 +437,37 @@ static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
 					goto errorLabel; \
 				} \
 			} \
-			else \
-				continue; \
+			MACRO_FUNC_ARRAY_NEXT \
 		}
 	//--------------------------------------------------
 
 	using func = decltype(MACRO_PROC_DEFINITION(MACRO_FUNC_ARRAY));
 
+#if defined(__GNUC__) && !defined(OXCE_SCRIPT_SWITCH_DISPATCH)
+	// threaded code, every operation jump directly to next one,
+	// this remove bound check of switch and give CPU separate branch for each operation.
+	// build with OXCE_SCRIPT_SWITCH_DISPATCH defined to compare it with the switch.
+	#define MACRO_FUNC_ARRAY_NEXT goto *procLabels[proc[(int)curr++]];
+	#define MACRO_FUNC_ARRAY_LABEL(H, L) &&procLabel_##H##L,
+	#define MACRO_FUNC_ARRAY_LOOP(H, L) \
+		procLabel_##H##L: \
+		MACRO_FUNC_ARRAY_BODY(0x##H##L)
+
+	static const void* const procLabels[256] =
+	{
+		MACRO_HEX_256(MACRO_FUNC_ARRAY_LABEL)
+	};
+
+	MACRO_FUNC_ARRAY_NEXT
+	MACRO_HEX_256(MACRO_FUNC_ARRAY_LOOP)
+
+	#undef MACRO_FUNC_ARRAY_LABEL
+#else
+	#define MACRO_FUNC_ARRAY_NEXT continue;
+	#define MACRO_FUNC_ARRAY_LOOP(POS) \
+		case (POS): \
+		MACRO_FUNC_ARRAY_BODY(POS)
+
 	while (true)
 	{
 		switch (proc[(int)curr++])
@@ -423,11 +475,14 @@ static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
 		MACRO_COPY_256(MACRO_FUNC_ARRAY_LOOP, 0)
 		}
 	}
+#endif
 
 	//--------------------------------------------------
 	//			removing helper macros
 	//--------------------------------------------------
 	#undef MACRO_FUNC_ARRAY_LOOP
+	#undef MACRO_FUNC_ARRAY_NEXT
+	#undef MACRO_FUNC_ARRAY_BODY
 	#undef MACRO_FUNC_ARRAY
 	//--------------------------------------------------
 
@@ -443,6 +498,18 @@ static inline void scriptExe(ScriptWorkerBase& data, const Uint8* proc)
 }
 
 
+/**
+ * Gets name of dispatch used by the script loop in this build.
+ */
+const char* ScriptWorkerBase::getDispatchName()
+{
+#if defined(__GNUC__) && !defined(OXCE_SCRIPT_SWITCH_DISPATCH)
+	return "threaded";
+#else
+	return "switch";
+#endif
+}
+
 ////////////////////////////////////////////////////////////
 //						Script class
 ////////////////////////////////////////////////////////////
@@ -529,6 +596,139 @@ void ScriptWorkerBlit::executeBlit(const Surface* src, Surface* dest, int x, int
 	}
 }
 
+namespace
+{
+
+/**
+ * Data collected by profiler for one script.
+ * Counters are atomic as scripts can run on worker threads (AI, explosions, map drawing).
+ */
+struct ScriptProfileData
+{
+	std::string hookName;
+	std::string parentName;
+	std::atomic<Uint64> calls{ 0 };
+	std::atomic<Uint64> ops{ 0 };
+	std::atomic<Uint64> nanoseconds{ 0 };
+
+	/// Gets total time in milliseconds.
+	double getTime() const { return nanoseconds.load(std::memory_order_relaxed) / 1000000.0; }
+};
+
+/// Profiled scripts, by their code. Empty when profiling is disabled.
+/// Entries are only added and removed while mods load or unload, otherwise it is only read.
+std::unordered_map<const Uint8*, ScriptProfileData> scriptProfileData;
+
+/**
+ * Execute script and add its cost to profiler data.
+ */
+void scriptExeProfiled(ScriptWorkerBase& data, const Uint8* proc)
+{
+	auto it = scriptProfileData.find(proc);
+	if (it == scriptProfileData.end())
+	{
+		scriptExe(data, proc);
+		return;
+	}
+
+	Uint64 ops = 0;
+	auto start = std::chrono::steady_clock::now();
+	scriptExe<true>(data, proc, &ops);
+	auto& profile = it->second;
+	profile.nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+	profile.calls.fetch_add(1, std::memory_order_relaxed);
+	profile.ops.fetch_add(ops, std::memory_order_relaxed);
+}
+
+}
+
+/**
+ * Start collecting data of new script, if profiling is enabled.
+ * Data of previous script that used same memory is discarded.
+ * @param script Parsed script.
+ * @param hookName Name of script hook, like `damageUnit`.
+ * @param parentName Name of rule that script belongs to.
+ */
+void ScriptProfiler::add(const ScriptContainerBase& script, const std::string& hookName, const std::string& parentName)
+{
+	if (Options::getProfileScripts() && script)
+	{
+		auto& profile = scriptProfileData[script.data()];
+		profile.calls = 0;
+		profile.ops = 0;
+		profile.nanoseconds = 0;
+		profile.hookName = hookName;
+		profile.parentName = parentName;
+	}
+}
+
+/**
+ * Stop collecting data of script, called when its code is freed,
+ * so next script that gets the same memory does not inherit the entry.
+ * @param script Script being destroyed or replaced.
+ */
+void ScriptProfiler::remove(const ScriptContainerBase& script)
+{
+	if (!scriptProfileData.empty() && script)
+	{
+		scriptProfileData.erase(script.data());
+	}
+}
+
+/**
+ * Write to log all scripts that were run, the most costly first.
+ */
+void ScriptProfiler::report()
+{
+	if (scriptProfileData.empty())
+	{
+		return;
+	}
+
+	std::vector<const ScriptProfileData*> sorted;
+	for (const auto& p : scriptProfileData)
+	{
+		if (p.second.calls > 0)
+		{
+			sorted.push_back(&p.second);
+		}
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const ScriptProfileData* a, const ScriptProfileData* b) { return a->getTime() > b->getTime(); });
+
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(3);
+	ss << "Script profile, " << sorted.size() << " scripts run:" << std::endl;
+	ss << std::left << std::setw(28) << "hook" << std::setw(40) << "rule" << std::right << std::setw(12) << "calls" << std::setw(14) << "ops" << std::setw(12) << "ms" << std::setw(12) << "us/call" << std::endl;
+	for (const auto* p : sorted)
+	{
+		ss << std::left << std::setw(28) << p->hookName << std::setw(40) << p->parentName << std::right << std::setw(12) << p->calls << std::setw(14) << p->ops
+			<< std::setw(12) << p->getTime() << std::setw(12) << p->getTime() * 1000 / p->calls << std::endl;
+	}
+	Log(LOG_INFO) << ss.str();
+}
+
+/**
+ * Destructor, discards profiler data of the script.
+ */
+ScriptContainerBase::~ScriptContainerBase()
+{
+	ScriptProfiler::remove(*this);
+}
+
+/**
+ * Move, discards profiler data of the replaced script.
+ */
+ScriptContainerBase &ScriptContainerBase::operator=(ScriptContainerBase&& other)
+{
+	if (this != &other)
+	{
+		ScriptProfiler::remove(*this);
+		_proc = std::move(other._proc);
+		_default = other._default;
+	}
+	return *this;
+}
+
 /**
  * Execute script with two arguments.
  * @return Result value from script.
@@ -537,12 +737,21 @@ void ScriptWorkerBase::executeBase(const Uint8* proc)
 {
 	if (proc)
 	{
-		scriptExe(*this, proc);
+		if (scriptProfileData.empty())
+		{
+			scriptExe(*this, proc);
+		}
+		else
+		{
+			scriptExeProfiled(*this, proc);
+		}
 	}
 }
 
 constexpr int log_buffer_limit_max = 500;
-static int log_buffer_limit_count = 0;
+static std::atomic<int> log_buffer_limit_count{ 0 };
+/// Sprite scripts can run on map drawing threads.
+static std::mutex log_buffer_mutex;
 
 /**
  * Add text to log buffer.
@@ -565,6 +774,7 @@ void ScriptWorkerBase::log_buffer_add(FuncRef<std::string()> func)
  */
 void ScriptWorkerBase::log_buffer_flush(ProgPos& p)
 {
+	std::lock_guard<std::mutex> lock(log_buffer_mutex);
 	if (++log_buffer_limit_count < log_buffer_limit_max)
 	{
 		Logger log;
@@ -1466,7 +1676,7 @@ bool parseReturn(const ScriptProcData& spd, ParserWriter& ph, const ScriptRefDat
 		}
 	}
 
-	ph.pushProc(Proc_exit);
+	ph.pushProcExit();
 	return true;
 }
 
@@ -2046,7 +2256,7 @@ ParserWriter::ParserWriter(
  */
 void ParserWriter::relese()
 {
-	pushProc(Proc_exit);
+	pushProcExit();
 	refLabels.forEachPosition(
 		[&](auto pos, ProgPos value)
 		{
@@ -2209,9 +2419,40 @@ ParserWriter::ReservedPos<ParserWriter::ProcOp> ParserWriter::pushProc(Uint8 pro
 {
 	auto curr = getCurrPos();
 	container._proc.push_back(procId);
+	lastProcPos = curr;
 	return { curr };
 }
 
+/**
+ * Pushing `exit` operation on proc vector, if possible merged with previous operation.
+ * Common script ends like `add_shade x y; return x;` then need one operation less.
+ * Can be turned off by `scriptFuseOps` option, to compare script speed.
+ */
+void ParserWriter::pushProcExit()
+{
+	// label pointing after last operation would skip it, then it can't end script.
+	if (Options::scriptFuseOps && lastProcPos != ProgPos::Unknown && (lastLabelPos == ProgPos::Unknown || lastLabelPos <= lastProcPos))
+	{
+		static_assert(helper::FuncGroup<Func_set>::ver() == helper::FuncGroup<Func_set_exit>::ver(), "Invalid size");
+		static_assert(helper::FuncGroup<Func_add_shade>::ver() == helper::FuncGroup<Func_add_shade_exit>::ver(), "Invalid size");
+
+		auto& procId = container._proc[static_cast<size_t>(lastProcPos)];
+		if (Proc_set <= procId && procId <= Proc_set_end)
+		{
+			procId = procId - Proc_set + Proc_set_exit;
+			lastProcPos = ProgPos::Unknown;
+			return;
+		}
+		if (Proc_add_shade <= procId && procId <= Proc_add_shade_end)
+		{
+			procId = procId - Proc_add_shade + Proc_add_shade_exit;
+			lastProcPos = ProgPos::Unknown;
+			return;
+		}
+	}
+	pushProc(Proc_exit);
+}
+
 /**
  * Updating previously added proc operation id.
  * @param pos Position of operation.
@@ -2282,6 +2523,10 @@ bool ParserWriter::setLabel(const ScriptRefData& data, ProgPos offset)
 		return false;
 	}
 	refLabels.setValue(temp.value, offset);
+	if (lastLabelPos == ProgPos::Unknown || lastLabelPos < offset)
+	{
+		lastLabelPos = offset;
+	}
 	return true;
 }
 
@@ -2429,7 +2674,7 @@ ScriptParserBase::ScriptParserBase(ScriptGlobal* shared, const std::string& name
 	//					op_data init
 	//--------------------------------------------------
 	#define MACRO_ALL_INIT(NAME, IMPL, ARGS, DESC) \
-		addParserBase(#NAME, DESC, nullptr, helper::FuncGroup<MACRO_FUNC_ID(NAME)>::overloadType(), &parseBuildinProc<MACRO_PROC_ID(NAME), helper::FuncGroup<MACRO_FUNC_ID(NAME)>>, nullptr, nullptr);
+		if (!isInternalProc(MACRO_PROC_ID(NAME))) addParserBase(#NAME, DESC, nullptr, helper::FuncGroup<MACRO_FUNC_ID(NAME)>::overloadType(), &parseBuildinProc<MACRO_PROC_ID(NAME), helper::FuncGroup<MACRO_FUNC_ID(NAME)>>, nullptr, nullptr);
 
 	MACRO_PROC_DEFINITION(MACRO_ALL_INIT)
 
@@ -2815,6 +3060,7 @@ bool ScriptParserBase::parseBase(ScriptContainerBase& destScript, const std::str
 			}
 			help.relese();
 			destScript = std::move(tempScript);
+			ScriptProfiler::add(destScript, _name, parentName);
 			return true;
 		}
 
@@ -2984,6 +3230,7 @@ void ScriptParserBase::parseNode(ScriptContainerBase& container, const std::stri
 	if (!container && !getDefault().empty())
 	{
 		parseBase(container, parentName, getDefault());
+		container._default = true;
 	}
 }
 
@@ -2999,6 +3246,7 @@ void ScriptParserBase::parseCode(ScriptContainerBase& container, const std::stri
 	if (!container && !getDefault().empty())
 	{
 		parseBase(container, parentName, getDefault());
+		container._default = true;
 	}
 }
 
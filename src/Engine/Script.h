@@ -373,7 +373,9 @@ struct TypeInfo
 class ScriptContainerBase
 {
 	friend struct ParserWriter;
+	friend class ScriptParserBase;
 	std::vector<Uint8> _proc;
+	bool _default = false;
 
 public:
 	/// Constructor.
@@ -384,12 +386,12 @@ public:
 	ScriptContainerBase(ScriptContainerBase&&) = default;
 
 	/// Destructor.
-	~ScriptContainerBase() = default;
+	~ScriptContainerBase();
 
 	/// Copy.
 	ScriptContainerBase &operator=(const ScriptContainerBase&) = delete;
 	/// Move.
-	ScriptContainerBase &operator=(ScriptContainerBase&&) = default;
+	ScriptContainerBase &operator=(ScriptContainerBase&&);
 
 	/// Test if is any script there.
 	explicit operator bool() const
@@ -402,6 +404,12 @@ public:
 	{
 		return *this ? _proc.data() : nullptr;
 	}
+
+	/// Is script parsed from default code of its parser.
+	bool isDefault() const
+	{
+		return _default;
+	}
 };
 
 /**
@@ -449,6 +457,12 @@ public:
 	{
 		return _events;
 	}
+
+	/// Is script parsed from default code of its parser and without any global events.
+	bool isDefault() const
+	{
+		return _current.isDefault() && (!_events || (!_events[0] && !_events[1]));
+	}
 };
 
 /**
@@ -470,6 +484,21 @@ public:
 	}
 };
 
+/**
+ * Collects number of calls, executed operations and time of each script,
+ * enabled by `-profileScripts` command line option.
+ */
+class ScriptProfiler
+{
+public:
+	/// Start collecting data of new script.
+	static void add(const ScriptContainerBase& script, const std::string& hookName, const std::string& parentName);
+	/// Stop collecting data of script.
+	static void remove(const ScriptContainerBase& script);
+	/// Write collected data to log.
+	static void report();
+};
+
 ////////////////////////////////////////////////////////////
 //					worker definition
 ////////////////////////////////////////////////////////////
@@ -723,6 +752,9 @@ public:
 		return ret;
 	}
 
+	/// Gets name of dispatch used by the script loop.
+	static const char* getDispatchName();
+
 	/// Add text to log buffer.
 	void log_buffer_add(FuncRef<std::string()> func);
 	/// Flush buffer to log file.
@@ -803,13 +835,14 @@ class ScriptWorkerBlit : public ScriptWorkerBase
 	/// Current script set in worker.
 	const Uint8* _proc;
 	const ScriptContainerBase* _events;
+	bool _default;
 
 public:
 	/// Type of output value from script.
 	using Output = ScriptOutputArgs<int&, int>;
 
 	/// Default constructor.
-	ScriptWorkerBlit() : ScriptWorkerBase(), _proc(nullptr), _events(nullptr)
+	ScriptWorkerBlit() : ScriptWorkerBase(), _proc(nullptr), _events(nullptr), _default(false)
 	{
 
 	}
@@ -824,6 +857,7 @@ public:
 		{
 			_proc = c.data();
 			_events = nullptr;
+			_default = c.isDefault();
 			updateBase<Output>(args...);
 		}
 	}
@@ -838,6 +872,7 @@ public:
 		{
 			_proc = c.data();
 			_events = c.dataEvents();
+			_default = c.isDefault();
 			updateBase<Output>(args...);
 		}
 	}
@@ -847,11 +882,18 @@ public:
 	/// Programmable blitting using script.
 	void executeBlit(const Surface* src, Surface* dest, int x, int y, int shade, GraphSubset mask);
 
+	/// Is default script set without any global events, its result depends only on arguments.
+	bool isDefault() const
+	{
+		return _default;
+	}
+
 	/// Clear all worker data.
 	void clear()
 	{
 		_proc = nullptr;
 		_events = nullptr;
+		_default = false;
 	}
 };
 
@@ -160,6 +160,10 @@ struct ParserWriter
 	std::vector<ScriptRefData> regStack;
 	/// Store position of blocks of code like "if" or "while".
 	std::vector<Block> codeBlocks;
+	/// Position of last operation id on proc vector.
+	ProgPos lastProcPos = ProgPos::Unknown;
+	/// Last position on proc vector where some label point.
+	ProgPos lastLabelPos = ProgPos::Unknown;
 
 
 
@@ -206,6 +210,9 @@ struct ParserWriter
 	/// Pushing proc operation id on proc vector.
 	ReservedPos<ProcOp> pushProc(Uint8 procId);
 
+	/// Pushing exit operation on proc vector, can merge it with previous operation.
+	void pushProcExit();
+
 	/// Updating previously added proc operation id.
 	void updateProc(ReservedPos<ProcOp> pos, int procOffset);
 
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ThreadPool.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Creates pool and starts worker threads.
+ * @param threads Number of worker threads, can be zero and then all tasks are run by `parallelFor` caller.
+ */
+ThreadPool::ThreadPool(size_t threads) : _stop(false)
+{
+	_workers.reserve(threads);
+	for (size_t i = 0; i < threads; ++i)
+	{
+		_workers.emplace_back(&ThreadPool::work, this);
+	}
+}
+
+/**
+ * Finishes all queued tasks and joins worker threads.
+ */
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_cond.notify_all();
+	for (auto& w : _workers)
+	{
+		w.join();
+	}
+}
+
+/**
+ * Takes tasks from queue until pool is stopped and queue is empty.
+ */
+void ThreadPool::work()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_cond.wait(lock, [this]{ return _stop || !_tasks.empty(); });
+			if (_tasks.empty())
+			{
+				return;
+			}
+			task = std::move(_tasks.front());
+			_tasks.pop_front();
+		}
+		task();
+	}
+}
+
+/**
+ * Converts user requested number of threads to usable value.
+ * @param requested Value from options, zero or less means "use all available cores".
+ * @return Number of threads, at least one.
+ */
+size_t ThreadPool::getThreadCount(int requested)
+{
+	if (requested > 0)
+	{
+		return (size_t)requested;
+	}
+	size_t hw = std::thread::hardware_concurrency();
+	return hw > 0 ? hw : 1;
+}
+
+}
@@ -0,0 +1,150 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <exception>
+#include <type_traits>
+
+namespace OpenXcom
+{
+
+/**
+ * Simple fixed size pool of worker threads.
+ * Tasks are run in FIFO order, results are returned by std::future.
+ * Workers must not touch SDL, Logger or any other not thread safe global state,
+ * all results should be merged back on the thread that owns the pool.
+ */
+class ThreadPool
+{
+	std::vector<std::thread> _workers;
+	std::deque<std::function<void()>> _tasks;
+	std::mutex _mutex;
+	std::condition_variable _cond;
+	bool _stop;
+
+	/// Main loop of the worker thread.
+	void work();
+
+public:
+	/// Creates pool with given number of threads.
+	ThreadPool(size_t threads);
+	/// Waits for all queued tasks and stops threads.
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/// Gets number of worker threads.
+	size_t size() const { return _workers.size(); }
+
+	/// Converts user requested number of threads to usable value, zero or less means "all cores".
+	static size_t getThreadCount(int requested);
+
+	/**
+	 * Adds a new task to the queue.
+	 * @param f Function to run on a worker thread.
+	 * @return Future with the function result or exception thrown by it.
+	 */
+	template<typename F>
+	auto submit(F&& f) -> std::future<std::invoke_result_t<F>>
+	{
+		using R = std::invoke_result_t<F>;
+		auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+		auto result = task->get_future();
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_tasks.emplace_back([task]{ (*task)(); });
+		}
+		_cond.notify_one();
+		return result;
+	}
+
+	/**
+	 * Runs `f(i)` for every `i` in range `[0, count)`, split in contiguous chunks across workers.
+	 * Calling thread takes part in the work and returns when all chunks are done.
+	 * First exception thrown by any chunk is rethrown.
+	 * @param count Number of items.
+	 * @param f Function called for each item index.
+	 */
+	template<typename F>
+	void parallelFor(size_t count, F&& f)
+	{
+		const size_t chunks = std::min(count, size() + 1);
+		if (chunks <= 1)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				f(i);
+			}
+			return;
+		}
+		auto runChunk = [&f, count, chunks](size_t c)
+		{
+			const size_t begin = count * c / chunks;
+			const size_t end = count * (c + 1) / chunks;
+			for (size_t i = begin; i < end; ++i)
+			{
+				f(i);
+			}
+		};
+		std::vector<std::future<void>> pending;
+		pending.reserve(chunks - 1);
+		for (size_t c = 1; c < chunks; ++c)
+		{
+			pending.push_back(submit([&runChunk, c]{ runChunk(c); }));
+		}
+		std::exception_ptr error;
+		try
+		{
+			runChunk(0);
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+		}
+		for (auto& p : pending)
+		{
+			try
+			{
+				p.get();
+			}
+			catch (...)
+			{
+				if (!error)
+				{
+					error = std::current_exception();
+				}
+			}
+		}
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+};
+
+}
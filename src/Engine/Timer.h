@@ -37,6 +37,7 @@ class Timer
 public:
 	static int maxFrameSkip;
 	static Uint32 gameSlowSpeed;
+	static bool headless;
 
 private:
 	Uint32 _start;
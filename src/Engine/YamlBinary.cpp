@@ -0,0 +1,282 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "YamlBinary.h"
+#include "Exception.h"
+
+namespace OpenXcom
+{
+
+namespace YamlBinary
+{
+
+namespace
+{
+
+/// Node type stored in lower bits of header byte.
+enum : unsigned char
+{
+	TypeNull = 0,
+	TypeScalar = 1,
+	TypeSequence = 2,
+	TypeMap = 3,
+	TypeMask = 3,
+};
+
+/// Tag stored in upper bits of header byte, most nodes have one of first three tags.
+enum : unsigned char
+{
+	TagPlain = 0 << 2,
+	TagQuoted = 1 << 2,
+	TagEmpty = 2 << 2,
+	TagCustom = 3 << 2,
+	TagMask = 3 << 2,
+};
+
+/// Flow style of sequence or map.
+const unsigned char FlowStyle = 1 << 4;
+
+const std::string TagPlainString = "?";
+const std::string TagQuotedString = "!";
+
+[[noreturn]] void throwCorrupted()
+{
+	throw Exception("Corrupted binary YAML data");
+}
+
+}
+
+/**
+ * Appends size or count in variable length encoding, 7 bits per byte.
+ * @param buffer Output buffer.
+ * @param value Value to write.
+ */
+void writeSize(std::vector<unsigned char> &buffer, size_t value)
+{
+	while (value >= 0x80)
+	{
+		buffer.push_back((unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+	buffer.push_back((unsigned char)value);
+}
+
+/**
+ * Reads size or count in variable length encoding.
+ * @param pos Current position, moved after the value.
+ * @param end End of buffer.
+ * @return Read value.
+ */
+size_t readSize(const unsigned char *&pos, const unsigned char *end)
+{
+	size_t value = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		if (pos == end)
+		{
+			throwCorrupted();
+		}
+		unsigned char b = *pos++;
+		value |= (size_t)(b & 0x7F) << shift;
+		if ((b & 0x80) == 0)
+		{
+			return value;
+		}
+	}
+	throwCorrupted();
+}
+
+/**
+ * Appends string with its length.
+ * @param buffer Output buffer.
+ * @param value String to write.
+ */
+void writeString(std::vector<unsigned char> &buffer, const std::string &value)
+{
+	writeSize(buffer, value.size());
+	buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+/**
+ * Reads string with its length.
+ * @param pos Current position, moved after the string.
+ * @param end End of buffer.
+ * @return Read string.
+ */
+std::string readString(const unsigned char *&pos, const unsigned char *end)
+{
+	size_t size = readSize(pos, end);
+	if ((size_t)(end - pos) < size)
+	{
+		throwCorrupted();
+	}
+	std::string value((const char*)pos, size);
+	pos += size;
+	return value;
+}
+
+/**
+ * Appends binary form of node tree.
+ * @param buffer Output buffer.
+ * @param node Node to write, can't be undefined.
+ */
+void write(std::vector<unsigned char> &buffer, const YAML::Node &node)
+{
+	unsigned char header;
+	switch (node.Type())
+	{
+	case YAML::NodeType::Scalar: header = TypeScalar; break;
+	case YAML::NodeType::Sequence: header = TypeSequence; break;
+	case YAML::NodeType::Map: header = TypeMap; break;
+	default: header = TypeNull; break;
+	}
+
+	const std::string &tag = node.Tag();
+	if (tag == TagPlainString)
+	{
+		header |= TagPlain;
+	}
+	else if (tag == TagQuotedString)
+	{
+		header |= TagQuoted;
+	}
+	else if (tag.empty())
+	{
+		header |= TagEmpty;
+	}
+	else
+	{
+		header |= TagCustom;
+	}
+	if (node.Style() == YAML::EmitterStyle::Flow)
+	{
+		header |= FlowStyle;
+	}
+	buffer.push_back(header);
+	if ((header & TagMask) == TagCustom)
+	{
+		writeString(buffer, tag);
+	}
+
+	switch (header & TypeMask)
+	{
+	case TypeScalar:
+		writeString(buffer, node.Scalar());
+		break;
+	case TypeSequence:
+		writeSize(buffer, node.size());
+		for (const YAML::Node &child : node)
+		{
+			write(buffer, child);
+		}
+		break;
+	case TypeMap:
+		writeSize(buffer, node.size());
+		for (YAML::const_iterator i = node.begin(); i != node.end(); ++i)
+		{
+			write(buffer, i->first);
+			write(buffer, i->second);
+		}
+		break;
+	}
+}
+
+/**
+ * Reads node tree from binary form.
+ * @param pos Current position, moved after the node.
+ * @param end End of buffer.
+ * @return New node tree.
+ */
+YAML::Node read(const unsigned char *&pos, const unsigned char *end)
+{
+	if (pos == end)
+	{
+		throwCorrupted();
+	}
+	const unsigned char header = *pos++;
+
+	std::string tag;
+	switch (header & TagMask)
+	{
+	case TagPlain: tag = TagPlainString; break;
+	case TagQuoted: tag = TagQuotedString; break;
+	case TagEmpty: break;
+	default: tag = readString(pos, end); break;
+	}
+
+	YAML::Node node;
+	switch (header & TypeMask)
+	{
+	case TypeScalar:
+		node = readString(pos, end);
+		break;
+	case TypeSequence:
+	{
+		node = YAML::Node(YAML::NodeType::Sequence);
+		size_t size = readSize(pos, end);
+		for (size_t i = 0; i < size; ++i)
+		{
+			node.push_back(read(pos, end));
+		}
+		break;
+	}
+	case TypeMap:
+	{
+		node = YAML::Node(YAML::NodeType::Map);
+		size_t size = readSize(pos, end);
+		for (size_t i = 0; i < size; ++i)
+		{
+			YAML::Node key = read(pos, end);
+			YAML::Node value = read(pos, end);
+			// keys were unique in source document, no need to search for duplicates
+			node.force_insert(key, value);
+		}
+		break;
+	}
+	default:
+		node = YAML::Node(YAML::NodeType::Null);
+		break;
+	}
+	node.SetTag(tag);
+	if (header & FlowStyle)
+	{
+		node.SetStyle(YAML::EmitterStyle::Flow);
+	}
+	return node;
+}
+
+/**
+ * Reads node tree from whole buffer.
+ * @param buffer Binary data created by `write`.
+ * @return New node tree.
+ */
+YAML::Node read(const std::vector<unsigned char> &buffer)
+{
+	const unsigned char *pos = buffer.data();
+	const unsigned char *end = pos + buffer.size();
+	YAML::Node node = read(pos, end);
+	if (pos != end)
+	{
+		throwCorrupted();
+	}
+	return node;
+}
+
+}
+
+}
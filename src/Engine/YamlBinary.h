@@ -0,0 +1,51 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+namespace OpenXcom
+{
+
+/**
+ * Compact binary form of YAML node trees.
+ * Keeps node types, tags, scalars and flow style, but not anchors or line numbers.
+ * Reading it back is many times faster than parsing YAML text.
+ */
+namespace YamlBinary
+{
+	/// Appends size or count in variable length encoding.
+	void writeSize(std::vector<unsigned char> &buffer, size_t value);
+	/// Reads size or count in variable length encoding.
+	size_t readSize(const unsigned char *&pos, const unsigned char *end);
+	/// Appends string with its length.
+	void writeString(std::vector<unsigned char> &buffer, const std::string &value);
+	/// Reads string with its length.
+	std::string readString(const unsigned char *&pos, const unsigned char *end);
+
+	/// Appends binary form of node tree.
+	void write(std::vector<unsigned char> &buffer, const YAML::Node &node);
+	/// Reads node tree from binary form.
+	YAML::Node read(const unsigned char *&pos, const unsigned char *end);
+	/// Reads node tree from whole buffer.
+	YAML::Node read(const std::vector<unsigned char> &buffer);
+}
+
+}
@@ -0,0 +1,309 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GeoscapeSimulation.h"
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <yaml-cpp/yaml.h>
+#include "GeoscapeState.h"
+#include "TargetGrid.h"
+#include "../Engine/Action.h"
+#include "../Engine/Exception.h"
+#include "../Engine/Game.h"
+#include "../Engine/Logger.h"
+#include "../Engine/Options.h"
+#include "../Engine/Screen.h"
+#include "../Mod/Mod.h"
+#include "../Mod/RuleUfo.h"
+#include "../Savegame/Base.h"
+#include "../Savegame/SavedGame.h"
+#include "../fmath.h"
+
+namespace OpenXcom
+{
+
+bool GeoscapeSimulation::_running = false;
+double GeoscapeSimulation::_handlerTime[GH_MAX] = { };
+Uint64 GeoscapeSimulation::_handlerCalls[GH_MAX] = { };
+int GeoscapeSimulation::_days = 0;
+bool GeoscapeSimulation::_cancelPressed = false;
+std::chrono::steady_clock::time_point GeoscapeSimulation::_startTime;
+
+namespace
+{
+
+const char *handlerNames[GH_MAX] = { "time5Seconds", "time10Minutes", "time30Minutes", "time1Hour", "time1Day", "time1Month" };
+
+/// Stand-in for a UFO in the target grid benchmark.
+struct GlobePoint
+{
+	double lon, lat;
+	double getLongitude() const { return lon; }
+	double getLatitude() const { return lat; }
+};
+
+/// Same great circle distance as Target::getDistance.
+double globeDistance(double lon1, double lat1, double lon2, double lat2)
+{
+	return acos(cos(lat1) * cos(lat2) * cos(lon2 - lon1) + sin(lat1) * sin(lat2));
+}
+
+}
+
+/**
+ * Loads a saved campaign and opens the geoscape at the fastest time speed.
+ * @param game Pointer to the core game.
+ * @param filename Save file name, in the user folder.
+ * @param days Number of game days to simulate.
+ */
+void GeoscapeSimulation::start(Game *game, const std::string &filename, int days)
+{
+	Log(LOG_INFO) << "Simulating " << days << " days of campaign " << filename;
+	SavedGame *s = new SavedGame();
+	try
+	{
+		s->load(filename, game->getMod(), game->getLanguage());
+	}
+	catch (Exception &e)
+	{
+		Log(LOG_ERROR) << "Failed to load " << filename << ": " << e.what();
+		delete s;
+		game->quit();
+		return;
+	}
+	catch (YAML::Exception &e)
+	{
+		Log(LOG_ERROR) << "Failed to load " << filename << ": " << e.what();
+		delete s;
+		game->quit();
+		return;
+	}
+	if (s->getSavedBattle() != 0 || s->getEnding() != END_NONE)
+	{
+		Log(LOG_ERROR) << filename << " is not a geoscape save";
+		delete s;
+		game->quit();
+		return;
+	}
+
+	game->setSavedGame(s);
+	if (Options::getBenchmarkTargetGrid())
+	{
+		std::string report = benchmarkTargetGrid(game);
+		std::cout << report;
+		Log(LOG_INFO) << report;
+		game->quit();
+		return;
+	}
+	Options::baseXResolution = Options::baseXGeoscape;
+	Options::baseYResolution = Options::baseYGeoscape;
+	game->getScreen()->resetDisplay(false);
+	GeoscapeState *gs = new GeoscapeState;
+	game->setState(gs);
+	s->setGamePtr(game);
+
+	for (int i = 0; i < GH_MAX; ++i)
+	{
+		_handlerTime[i] = 0;
+		_handlerCalls[i] = 0;
+	}
+	_days = days;
+	_cancelPressed = false;
+	_startTime = std::chrono::steady_clock::now();
+	_running = true;
+	gs->timerReset();
+}
+
+/**
+ * Called at the end of every game day, stops the simulation
+ * when the requested number of days passed.
+ * @param game Pointer to the core game.
+ * @return True if the simulation is over.
+ */
+bool GeoscapeSimulation::dayEnded(Game *game)
+{
+	if (_handlerCalls[GH_1DAY] >= (Uint64)_days)
+	{
+		finish(game, "finished");
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Presses cancel on whatever popup is on top of the geoscape, as there's no
+ * player to do it, or OK if the popup is still there on the next frame.
+ * Stops the simulation if a battle was started or the campaign is over.
+ * @param game Pointer to the core game.
+ * @param state Pointer to the active state.
+ */
+void GeoscapeSimulation::dismissMessages(Game *game, State *state)
+{
+	if (game->getSavedGame()->getSavedBattle() != 0)
+	{
+		finish(game, "ended early, a battle was started");
+		return;
+	}
+	if (game->getSavedGame()->getEnding() != END_NONE)
+	{
+		finish(game, "ended early, the campaign is over");
+		return;
+	}
+	if (dynamic_cast<GeoscapeState*>(state) != 0)
+	{
+		return;
+	}
+	SDL_Event ev = {};
+	ev.type = SDL_KEYDOWN;
+	ev.key.state = SDL_PRESSED;
+	ev.key.keysym.sym = _cancelPressed ? Options::keyOk : Options::keyCancel;
+	_cancelPressed = true;
+	Action action = Action(&ev, 1.0, 1.0, 0, 0);
+	state->handle(&action);
+}
+
+/**
+ * Called when a state is pushed or popped and the new top state got initialized.
+ * Popups are told apart by this and not by their address, as a new popup
+ * can be allocated where the last dismissed one was.
+ */
+void GeoscapeSimulation::stateActivated()
+{
+	_cancelPressed = false;
+}
+
+/**
+ * Prints game time advanced per real time, time spent in each handler and quits the game.
+ * Handlers don't overlap, the rest of the time goes to dogfights, popups and the game loop.
+ * @param game Pointer to the core game.
+ * @param reason Why the simulation ended.
+ */
+void GeoscapeSimulation::finish(Game *game, const std::string &reason)
+{
+	double total = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _startTime).count();
+	double simulated = _handlerCalls[GH_5SECONDS] * 5.0;
+
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(1);
+	ss << "Geoscape simulation " << reason << ": " << _handlerCalls[GH_1DAY] << " days in " << total << " ms, "
+		<< (total > 0 ? simulated * 1000 / total : 0) << " game seconds per second" << std::endl;
+	ss << std::left << std::setw(16) << "handler" << std::right << std::setw(12) << "ms" << std::setw(10) << "calls" << std::setw(8) << "%" << std::setw(12) << "ms/call" << std::endl;
+	for (int i = 0; i < GH_MAX; ++i)
+	{
+		ss << std::left << std::setw(16) << handlerNames[i] << std::right << std::setw(12) << _handlerTime[i] << std::setw(10) << _handlerCalls[i]
+			<< std::setw(8) << (total > 0 ? _handlerTime[i] * 100 / total : 0) << std::setw(12) << (_handlerCalls[i] > 0 ? _handlerTime[i] / _handlerCalls[i] : 0) << std::endl;
+	}
+
+	std::cout << ss.str();
+	Log(LOG_INFO) << ss.str();
+
+	_running = false;
+	game->quit();
+}
+
+/**
+ * Times the search for UFOs close enough to detect a base, as done by time10Minutes,
+ * once checking the distance to every UFO and once asking a target grid first.
+ * Uses the bases of the save, the largest UFO sight range of the mod and growing numbers
+ * of UFOs spread evenly over the globe by a fixed seed, so runs can be compared.
+ * The game RNG is not touched. Only run with -benchmarkTargetGrid, in place of the simulation.
+ * @param game Pointer to the core game.
+ * @return Table of timings for the report.
+ */
+std::string GeoscapeSimulation::benchmarkTargetGrid(Game *game)
+{
+	const int Ticks = 144; // ten minute steps in a day
+	const std::vector<Base*> &bases = *game->getSavedGame()->getBases();
+	int maxSightRange = 0;
+	for (auto &type : game->getMod()->getUfosList())
+	{
+		maxSightRange = std::max(maxSightRange, game->getMod()->getUfo(type)->getStats().sightRange);
+	}
+	const double range = Nautical(maxSightRange);
+
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(2);
+	ss << "UFO search near " << bases.size() << " bases, " << maxSightRange << " nm, " << Ticks << " ticks" << std::endl;
+	ss << std::left << std::setw(16) << "UFOs" << std::right << std::setw(12) << "scan ms" << std::setw(12) << "grid ms" << std::setw(10) << "found" << std::endl;
+
+	std::mt19937 gen(1);
+	std::uniform_real_distribution<double> lonDist(0, 2 * M_PI), zDist(-1, 1);
+	for (int count : { 500, 1000, 2000, 5000 })
+	{
+		std::vector<GlobePoint> ufos(count);
+		for (auto &ufo : ufos)
+		{
+			ufo.lon = lonDist(gen);
+			ufo.lat = asin(zDist(gen));
+		}
+
+		size_t foundScan = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (int tick = 0; tick < Ticks; ++tick)
+		{
+			for (auto base : bases)
+			{
+				for (auto &ufo : ufos)
+				{
+					if (globeDistance(base->getLongitude(), base->getLatitude(), ufo.lon, ufo.lat) < range)
+					{
+						++foundScan;
+					}
+				}
+			}
+		}
+		double scanMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		size_t foundGrid = 0;
+		std::vector<GlobePoint*> near;
+		start = std::chrono::steady_clock::now();
+		for (int tick = 0; tick < Ticks; ++tick)
+		{
+			// filled again every tick, as UFOs move between ticks
+			TargetGrid<GlobePoint> grid;
+			for (auto &ufo : ufos)
+			{
+				grid.insert(&ufo);
+			}
+			for (auto base : bases)
+			{
+				grid.query(base->getLongitude(), base->getLatitude(), range, near);
+				for (auto ufo : near)
+				{
+					if (globeDistance(base->getLongitude(), base->getLatitude(), ufo->lon, ufo->lat) < range)
+					{
+						++foundGrid;
+					}
+				}
+			}
+		}
+		double gridMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		ss << std::left << std::setw(16) << count << std::right << std::setw(12) << scanMs << std::setw(12) << gridMs << std::setw(10) << foundGrid;
+		if (foundGrid != foundScan)
+		{
+			ss << " (scan found " << foundScan << ", grid missed UFOs)";
+		}
+		ss << std::endl;
+	}
+	return ss.str();
+}
+
+}
@@ -0,0 +1,95 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <string>
+#include <SDL_types.h>
+
+namespace OpenXcom
+{
+
+class Game;
+class State;
+
+/// Geoscape time handlers timed by the geoscape simulation.
+enum GeoscapeHandler { GH_5SECONDS, GH_10MINUTES, GH_30MINUTES, GH_1HOUR, GH_1DAY, GH_1MONTH, GH_MAX };
+
+/**
+ * Advances a saved campaign as fast as possible without player input or rendering,
+ * answering popups with their default choice, and reports how much time
+ * was spent in each geoscape time handler.
+ * Used to profile late game content from the command line (-simulateGeoscape FILE -simulateDays N).
+ * With -benchmarkTargetGrid the save is only used to time UFO searches near its bases.
+ */
+class GeoscapeSimulation
+{
+private:
+	static bool _running;
+	static double _handlerTime[GH_MAX];
+	static Uint64 _handlerCalls[GH_MAX];
+	static int _days;
+	static bool _cancelPressed;
+	static std::chrono::steady_clock::time_point _startTime;
+
+	/// Prints the timings and quits the game.
+	static void finish(Game *game, const std::string &reason);
+	/// Times UFO lookups near bases with and without a target grid.
+	static std::string benchmarkTargetGrid(Game *game);
+public:
+	/**
+	 * Measures time spent in a time handler, when the simulation is running.
+	 */
+	class HandlerTimer
+	{
+		GeoscapeHandler _handler;
+		bool _active;
+		std::chrono::steady_clock::time_point _start;
+	public:
+		/// Starts timing a handler.
+		HandlerTimer(GeoscapeHandler handler) : _handler(handler), _active(_running)
+		{
+			if (_active)
+			{
+				_start = std::chrono::steady_clock::now();
+			}
+		}
+		/// Adds time spent in the scope to the handler.
+		~HandlerTimer()
+		{
+			if (_active)
+			{
+				_handlerTime[_handler] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _start).count();
+				_handlerCalls[_handler] += 1;
+			}
+		}
+	};
+
+	/// Loads a saved campaign and starts simulating it.
+	static void start(Game *game, const std::string &filename, int days);
+	/// Is a geoscape simulation running?
+	static bool isRunning() { return _running; }
+	/// Counts passed days and stops the simulation after the requested number.
+	static bool dayEnded(Game *game);
+	/// Answers any popup shown on top of the geoscape.
+	static void dismissMessages(Game *game, State *state);
+	/// Notes that a new state is on top of the stack.
+	static void stateActivated();
+};
+
+}
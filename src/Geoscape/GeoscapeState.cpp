@@ -35,6 +35,8 @@
 #include "../Engine/Collections.h"
 #include "../Engine/Unicode.h"
 #include "Globe.h"
+#include "GeoscapeSimulation.h"
+#include "TargetGrid.h"
 #include "../Interface/ComboBox.h"
 #include "../Interface/Text.h"
 #include "../Interface/TextButton.h"
@@ -669,6 +671,13 @@ void GeoscapeState::handle(Action *action)
 					}
 				}
 			}
+			// "ctrl-o" - globe rotation benchmark
+			if (action->getDetails()->key.keysym.sym == SDLK_o)
+			{
+				std::string summary = _globe->benchmarkRotation(200);
+				Unicode::upperCase(summary);
+				_txtDebug->setText(summary);
+			}
 			// "ctrl-c"
 			if (action->getDetails()->key.keysym.sym == SDLK_c)
 			{
@@ -913,12 +922,19 @@ void GeoscapeState::timeAdvance()
 		case TIME_5SEC:
 			time5Seconds();
 		}
+		if (trigger >= TIME_1DAY && GeoscapeSimulation::isRunning() && GeoscapeSimulation::dayEnded(_game))
+		{
+			return;
+		}
 	}
 
 	_pause = !_dogfightsToBeStarted.empty() || _zoomInEffectTimer->isRunning() || _zoomOutEffectTimer->isRunning();
 
 	timeDisplay();
-	_globe->draw();
+	if (!Options::isHeadless())
+	{
+		_globe->draw();
+	}
 }
 
 /**
@@ -947,6 +963,7 @@ const std::vector<Craft*>* GeoscapeState::updateActiveCrafts()
  */
 void GeoscapeState::time5Seconds()
 {
+	GeoscapeSimulation::HandlerTimer timer(GH_5SECONDS);
 	// If in "slow mode", handle UFO hunting and escorting logic every 5 seconds, not only every 10 minutes
 	if ((_timeSpeed == _btn5Secs || _timeSpeed == _btn1Min) && _game->getMod()->getHunterKillerFastRetarget())
 	{
@@ -1529,6 +1546,7 @@ struct SetRetaliationTarget
  */
 void GeoscapeState::time10Minutes()
 {
+	GeoscapeSimulation::HandlerTimer timer(GH_10MINUTES);
 	for (std::vector<Base*>::iterator i = _game->getSavedGame()->getBases()->begin(); i != _game->getSavedGame()->getBases()->end(); ++i)
 	{
 		// Fuel consumption for XCOM craft.
@@ -1575,14 +1593,24 @@ void GeoscapeState::time10Minutes()
 			}
 		}
 	}
+	// Only UFOs near a base can detect it, skip the rest.
+	TargetGrid<Ufo> ufoGrid;
+	int maxSightRange = 0;
+	for (auto ufo : *_game->getSavedGame()->getUfos())
+	{
+		ufoGrid.insert(ufo);
+		maxSightRange = std::max(maxSightRange, ufo->getCraftStats().sightRange);
+	}
+	std::vector<Ufo*> nearUfos;
 	if (Options::aggressiveRetaliation)
 	{
 		// Detect as many bases as possible.
 		for (std::vector<Base*>::iterator iBase = _game->getSavedGame()->getBases()->begin(); iBase != _game->getSavedGame()->getBases()->end(); ++iBase)
 		{
 			// Find a UFO that detected this base, if any.
-			std::vector<Ufo*>::const_iterator uu = std::find_if (_game->getSavedGame()->getUfos()->begin(), _game->getSavedGame()->getUfos()->end(), DetectXCOMBase(**iBase));
-			if (uu != _game->getSavedGame()->getUfos()->end())
+			ufoGrid.query((*iBase)->getLongitude(), (*iBase)->getLatitude(), Nautical(maxSightRange), nearUfos);
+			std::vector<Ufo*>::const_iterator uu = std::find_if (nearUfos.begin(), nearUfos.end(), DetectXCOMBase(**iBase));
+			if (uu != nearUfos.end())
 			{
 				// Base found
 				(*iBase)->setRetaliationTarget(true);
@@ -1596,8 +1624,9 @@ void GeoscapeState::time10Minutes()
 		for (std::vector<Base*>::iterator iBase = _game->getSavedGame()->getBases()->begin(); iBase != _game->getSavedGame()->getBases()->end(); ++iBase)
 		{
 			// Find a UFO that detected this base, if any.
-			std::vector<Ufo*>::const_iterator uu = std::find_if (_game->getSavedGame()->getUfos()->begin(), _game->getSavedGame()->getUfos()->end(), DetectXCOMBase(**iBase));
-			if (uu != _game->getSavedGame()->getUfos()->end())
+			ufoGrid.query((*iBase)->getLongitude(), (*iBase)->getLatitude(), Nautical(maxSightRange), nearUfos);
+			std::vector<Ufo*>::const_iterator uu = std::find_if (nearUfos.begin(), nearUfos.end(), DetectXCOMBase(**iBase));
+			if (uu != nearUfos.end())
 			{
 				discovered[_game->getSavedGame()->locateRegion(**iBase)] = *iBase;
 			}
@@ -1869,6 +1898,7 @@ bool GeoscapeState::processMissionSite(MissionSite *site)
  */
 void GeoscapeState::time30Minutes()
 {
+	GeoscapeSimulation::HandlerTimer timer(GH_30MINUTES);
 	// Decrease mission countdowns
 	for (auto am : _game->getSavedGame()->getAlienMissions())
 	{
@@ -2136,6 +2166,7 @@ void GeoscapeState::time30Minutes()
  */
 void GeoscapeState::time1Hour()
 {
+	GeoscapeSimulation::HandlerTimer timer(GH_1HOUR);
 	// Handle craft maintenance
 	for (std::vector<Base*>::iterator i = _game->getSavedGame()->getBases()->begin(); i != _game->getSavedGame()->getBases()->end(); ++i)
 	{
@@ -2442,6 +2473,7 @@ void GenerateSupplyMission::operator()(AlienBase *base) const
  */
 void GeoscapeState::time1Day()
 {
+	GeoscapeSimulation::HandlerTimer timer(GH_1DAY);
 	SavedGame *saveGame = _game->getSavedGame();
 	Mod *mod = _game->getMod();
 	bool psiStrengthEval = (Options::psiStrengthEval && saveGame->isResearched(mod->getPsiRequirements()));
@@ -2832,6 +2864,7 @@ void GeoscapeState::time1Day()
  */
 void GeoscapeState::time1Month()
 {
+	GeoscapeSimulation::HandlerTimer timer(GH_1MONTH);
 	_game->getSavedGame()->addMonth();
 
 	// Determine alien mission for this month.
@@ -2901,6 +2934,12 @@ void GeoscapeState::timerReset()
 	SDL_Event ev;
 	ev.button.button = SDL_BUTTON_LEFT;
 	Action act(&ev, _game->getScreen()->getXScale(), _game->getScreen()->getYScale(), _game->getScreen()->getCursorTopBlackBand(), _game->getScreen()->getCursorLeftBlackBand());
+	// the simulation never slows down
+	if (GeoscapeSimulation::isRunning())
+	{
+		_btn1Day->mousePress(&act, this);
+		return;
+	}
 	_btn5Secs->mousePress(&act, this);
 }
 
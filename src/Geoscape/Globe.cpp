@@ -52,7 +52,9 @@
 #include "../Mod/RuleGlobe.h"
 #include "../Mod/Texture.h"
 #include "../Interface/Cursor.h"
+#include <sstream>
 #include "../Engine/Screen.h"
+#include "../Engine/Benchmark.h"
 
 namespace OpenXcom
 {
@@ -349,6 +351,7 @@ Globe::Globe(Game* game, int cenX, int cenY, int width, int height, int x, int y
 	setupRadii(width, height);
 	setZoom(_zoom);
 
+	loadLand();
 	cachePolygons();
 }
 
@@ -364,11 +367,6 @@ Globe::~Globe()
 	delete _texture;
 	delete _radars;
 	delete _clipper;
-
-	for (std::list<Polygon*>::iterator i = _cacheLand.begin(); i != _cacheLand.end(); ++i)
-	{
-		delete *i;
-	}
 }
 
 /**
@@ -830,60 +828,164 @@ std::vector<Target*> Globe::getTargets(int x, int y, bool craft, Craft *currentC
 }
 
 /**
- * Takes care of pre-calculating all the polygons currently visible
- * on the globe and caching them so they only need to be recalculated
- * when the globe is actually moved.
+ * Converts the points of all land polygons to unit vectors once,
+ * so following projections don't need to call trigonometric functions.
  */
-void Globe::cachePolygons()
+void Globe::loadLand()
 {
-	cache(_rules->getPolygons(), &_cacheLand);
+	_landX.clear();
+	_landY.clear();
+	_landZ.clear();
+	_landFirst.clear();
+	_landTexture.clear();
+	for (std::list<Polygon*>::iterator i = _rules->getPolygons()->begin(); i != _rules->getPolygons()->end(); ++i)
+	{
+		_landFirst.push_back(_landX.size());
+		_landTexture.push_back((*i)->getTexture());
+		for (int j = 0; j < (*i)->getPoints(); ++j)
+		{
+			double lon = (*i)->getLongitude(j);
+			double lat = (*i)->getLatitude(j);
+			_landX.push_back(cos(lat) * cos(lon));
+			_landY.push_back(cos(lat) * sin(lon));
+			_landZ.push_back(sin(lat));
+		}
+	}
+	_landFirst.push_back(_landX.size());
+	_screenX.resize(_landX.size());
+	_screenY.resize(_landX.size());
+	_screenZ.resize(_landX.size());
 }
 
 /**
- * Caches a set of polygons.
- * @param polygons Pointer to list of polygons.
- * @param cache Pointer to cache.
+ * Takes care of pre-calculating all the polygons currently visible
+ * on the globe and caching them so they only need to be recalculated
+ * when the globe is actually moved.
  */
-void Globe::cache(std::list<Polygon*> *polygons, std::list<Polygon*> *cache)
+void Globe::cachePolygons()
 {
-	// Clear existing cache
-	for (std::list<Polygon*>::iterator i = cache->begin(); i != cache->end(); ++i)
+	const double sinLon = sin(_cenLon), cosLon = cos(_cenLon);
+	const double sinLat = sin(_cenLat), cosLat = cos(_cenLat);
+
+	// Rotate all points to the view and project them at once
+	const size_t points = _landX.size();
+	for (size_t i = 0; i < points; ++i)
 	{
-		delete *i;
+		// cos(lat) * cos(lon - _cenLon) and cos(lat) * sin(lon - _cenLon)
+		double c = _landX[i] * cosLon + _landY[i] * sinLon;
+		double s = _landY[i] * cosLon - _landX[i] * sinLon;
+		_screenZ[i] = cosLat * c + sinLat * _landZ[i];
+		_screenX[i] = _cenX + (Sint16)floor(_radius * s);
+		_screenY[i] = _cenY + (Sint16)floor(_radius * (cosLat * _landZ[i] - sinLat * c));
 	}
-	cache->clear();
 
-	// Pre-calculate values to cache
-	for (std::list<Polygon*>::iterator i = polygons->begin(); i != polygons->end(); ++i)
+	_cacheLand.clear();
+	for (size_t i = 0; i + 1 < _landFirst.size(); ++i)
 	{
 		// Is quad on the back face?
 		double closest = 0.0;
-		double z;
 		double furthest = 0.0;
-		for (int j = 0; j < (*i)->getPoints(); ++j)
+		for (int j = _landFirst[i]; j < _landFirst[i + 1]; ++j)
 		{
-			z = cos(_cenLat) * cos((*i)->getLatitude(j)) * cos((*i)->getLongitude(j) - _cenLon) + sin(_cenLat) * sin((*i)->getLatitude(j));
-			if (z > closest)
-				closest = z;
-			else if (z < furthest)
-				furthest = z;
+			closest = std::max(closest, _screenZ[j]);
+			furthest = std::min(furthest, _screenZ[j]);
 		}
 		if (-furthest > closest)
 			continue;
 
-		Polygon* p = new Polygon(**i);
+		_cacheLand.push_back(i);
+	}
+}
+
+/**
+ * Measures how long it takes to draw the globe while it keeps rotating at max zoom,
+ * like when holding a rotation key, and how much of it goes to projecting the land.
+ * Projection is timed twice: the current one from precomputed unit vectors,
+ * and the previous one that copied every front facing polygon and projected
+ * its points with polarToCart. The view is restored afterwards.
+ * Results are written to the log.
+ * @param frames How many frames are drawn.
+ * @return Short summary for the debug message.
+ */
+std::string Globe::benchmarkRotation(int frames)
+{
+	const double oldLon = _cenLon, oldLat = _cenLat;
+	const size_t oldZoom = _zoom;
+	setZoom(_zoomRadius.size() - 1);
+	const double step = ROTATE_LONGITUDE / (_zoom + 1);
 
-		// Convert coordinates
-		for (int j = 0; j < p->getPoints(); ++j)
+	std::ostringstream context;
+	context << getWidth() << "x" << getHeight() << ", zoom " << _zoomRadius.size() - 1 << ", "
+		<< _landFirst.size() - 1 << " polygons, " << _landX.size() << " points";
+	Benchmark benchmark("Globe rotation", context.str());
+
+	double ms = Benchmark::time([&]
+	{
+		for (int i = 0; i < frames; ++i)
+		{
+			_cenLon += step;
+			invalidate();
+			draw();
+		}
+	});
+	benchmark.add("draw", ms, frames, "frame");
+
+	ms = Benchmark::time([&]
+	{
+		for (int i = 0; i < frames; ++i)
 		{
-			Sint16 x, y;
-			polarToCart(p->getLongitude(j), p->getLatitude(j), &x, &y);
-			p->setX(j, x);
-			p->setY(j, y);
+			_cenLon += step;
+			cachePolygons();
 		}
+	});
+	benchmark.add("projection", ms, frames, "frame");
 
-		cache->push_back(p);
+	std::list<Polygon*> cache;
+	ms = Benchmark::time([&]
+	{
+		for (int i = 0; i < frames; ++i)
+		{
+			_cenLon += step;
+			for (auto *p : cache)
+			{
+				delete p;
+			}
+			cache.clear();
+			for (auto *polygon : *_rules->getPolygons())
+			{
+				double closest = 0.0;
+				double furthest = 0.0;
+				for (int j = 0; j < polygon->getPoints(); ++j)
+				{
+					double z = cos(_cenLat) * cos(polygon->getLatitude(j)) * cos(polygon->getLongitude(j) - _cenLon) + sin(_cenLat) * sin(polygon->getLatitude(j));
+					if (z > closest)
+						closest = z;
+					else if (z < furthest)
+						furthest = z;
+				}
+				if (-furthest > closest)
+					continue;
+				Polygon *p = new Polygon(*polygon);
+				for (int j = 0; j < p->getPoints(); ++j)
+				{
+					Sint16 x, y;
+					polarToCart(p->getLongitude(j), p->getLatitude(j), &x, &y);
+					p->setX(j, x);
+					p->setY(j, y);
+				}
+				cache.push_back(p);
+			}
+		}
+	});
+	benchmark.add("polarToCart projection", ms, frames, "frame");
+	for (auto *p : cache)
+	{
+		delete p;
 	}
+
+	setZoom(oldZoom);
+	center(oldLon, oldLat);
+	return benchmark.getSummary();
 }
 
 /**
@@ -976,19 +1078,12 @@ void Globe::drawOcean()
  */
 void Globe::drawLand()
 {
-	Sint16 x[4], y[4];
-
-	for (std::list<Polygon*>::iterator i = _cacheLand.begin(); i != _cacheLand.end(); ++i)
+	for (int i : _cacheLand)
 	{
-		// Convert coordinates
-		for (int j = 0; j < (*i)->getPoints(); ++j)
-		{
-			x[j] = (*i)->getX(j);
-			y[j] = (*i)->getY(j);
-		}
+		int first = _landFirst[i];
 
 		// Apply textures according to zoom and shade
-		drawTexturedPolygon(x, y, (*i)->getPoints(), _texture->getFrame((*i)->getTexture() + _zoomTexture), 0, 0);
+		drawTexturedPolygon(&_screenX[first], &_screenY[first], _landFirst[i + 1] - first, _texture->getFrame(_landTexture[i] + _zoomTexture), 0, 0);
 	}
 }
 
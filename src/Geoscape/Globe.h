@@ -64,7 +64,17 @@ private:
 	bool _hover, _craft;
 	int _blink;
 	Timer *_blinkTimer, *_rotTimer;
-	std::list<Polygon*> _cacheLand;
+	/// Points of all land polygons as unit vectors, polygon after polygon.
+	std::vector<double> _landX, _landY, _landZ;
+	/// Index of the first point of each land polygon, and one past the last point.
+	std::vector<int> _landFirst;
+	/// Texture of each land polygon.
+	std::vector<int> _landTexture;
+	/// Screen position and depth of all land points for the current view.
+	std::vector<Sint16> _screenX, _screenY;
+	std::vector<double> _screenZ;
+	/// Land polygons facing the viewer.
+	std::vector<int> _cacheLand;
 	FastLineClip *_clipper;
 	double _radius, _radiusStep;
 	///normal of each pixel in earth globe per zoom level
@@ -87,8 +97,8 @@ private:
 	Polygon* getPolygonFromLonLat(double lon, double lat) const;
 	/// Checks if a target is near a point.
 	bool targetNear(Target* target, int x, int y) const;
-	/// Caches a set of polygons.
-	void cache(std::list<Polygon*> *polygons, std::list<Polygon*> *cache);
+	/// Converts the land polygons to unit vectors.
+	void loadLand();
 	/// Get position of sun relative to given position in polar cords and date.
 	Cord getSunDirection(double lon, double lat) const;
 	/// Draw globe range circle.
@@ -163,6 +173,8 @@ public:
 	std::vector<Target*> getTargets(int x, int y, bool craft, Craft *currentCraft) const;
 	/// Caches visible globe polygons.
 	void cachePolygons();
+	/// Measures frame and projection time while rotating the globe at max zoom.
+	std::string benchmarkRotation(int frames);
 	/// Sets the palette of the globe.
 	void setPalette(const SDL_Color *colors, int firstcolor = 0, int ncolors = 256) override;
 	/// Handles the timers.
@@ -0,0 +1,130 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "../fmath.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Buckets targets on the globe by latitude and longitude,
+ * to find the ones that can be in range of a point without
+ * measuring the distance to every one of them.
+ * Positions are copied when a target is added, so the grid
+ * has to be filled again after targets move.
+ */
+template<typename T>
+class TargetGrid
+{
+	static constexpr int CellsLat = 36;
+	static constexpr int CellsLon = 72;
+	static constexpr double CellSize = M_PI / CellsLat;
+
+	std::vector<T*> _targets;
+	std::vector<std::vector<int>> _cells;
+
+	/// Gets the latitude row of a latitude.
+	static int getRow(double lat)
+	{
+		return Clamp((int)std::floor((lat + M_PI_2) / CellSize), 0, CellsLat - 1);
+	}
+	/// Gets the longitude column of a longitude, wrapped around the globe.
+	static int getColumn(double lon)
+	{
+		int col = (int)std::floor(lon / CellSize) % CellsLon;
+		return col < 0 ? col + CellsLon : col;
+	}
+public:
+	/// Creates an empty grid.
+	TargetGrid() : _cells(CellsLat * CellsLon) { }
+
+	/// Removes all targets.
+	void clear()
+	{
+		_targets.clear();
+		for (auto &cell : _cells)
+		{
+			cell.clear();
+		}
+	}
+
+	/// Adds a target at its current position.
+	void insert(T *target)
+	{
+		_cells[getRow(target->getLatitude()) * CellsLon + getColumn(target->getLongitude())].push_back(_targets.size());
+		_targets.push_back(target);
+	}
+
+	/**
+	 * Gets all targets that can be within a great circle distance of a point,
+	 * in the order they were added. Callers still need to check the distance.
+	 * @param lon Longitude of the point.
+	 * @param lat Latitude of the point.
+	 * @param range Distance in radian.
+	 * @param result Vector to fill with targets.
+	 */
+	void query(double lon, double lat, double range, std::vector<T*> &result) const
+	{
+		result.clear();
+		if (_targets.empty())
+		{
+			return;
+		}
+		// targets exactly at the edge still need to be found
+		range += 1e-6;
+
+		double latMin = lat - range;
+		double latMax = lat + range;
+		int colMin = 0;
+		int colMax = CellsLon - 1;
+		if (latMin > -M_PI_2 && latMax < M_PI_2)
+		{
+			// widest longitude span of a circle that doesn't cover a pole
+			double lonSpan = std::asin(std::min(1.0, std::sin(range) / std::cos(lat)));
+			int first = (int)std::floor((lon - lonSpan) / CellSize);
+			int last = (int)std::floor((lon + lonSpan) / CellSize);
+			if (last - first < CellsLon)
+			{
+				colMin = first;
+				colMax = last;
+			}
+		}
+
+		std::vector<int> found;
+		for (int row = getRow(latMin); row <= getRow(latMax); ++row)
+		{
+			for (int col = colMin; col <= colMax; ++col)
+			{
+				int wrapped = col % CellsLon;
+				const auto &cell = _cells[row * CellsLon + (wrapped < 0 ? wrapped + CellsLon : wrapped)];
+				found.insert(found.end(), cell.begin(), cell.end());
+			}
+		}
+		std::sort(found.begin(), found.end());
+		for (int i : found)
+		{
+			result.push_back(_targets[i]);
+		}
+	}
+};
+
+}
@@ -20,6 +20,7 @@
 #include "ListGamesState.h"
 #include "../Engine/Logger.h"
 #include "../Savegame/SavedGame.h"
+#include "../Savegame/SaveIndex.h"
 #include "../Engine/Game.h"
 #include "../Engine/Action.h"
 #include "../Engine/Exception.h"
@@ -90,7 +91,7 @@ struct compareSaveTimestamp
  * @param firstValidRow First row containing saves.
  * @param autoquick Show auto/quick saved games?
  */
-ListGamesState::ListGamesState(OptionsOrigin origin, int firstValidRow, bool autoquick) : _origin(origin), _firstValidRow(firstValidRow), _autoquick(autoquick), _sortable(true)
+ListGamesState::ListGamesState(OptionsOrigin origin, int firstValidRow, bool autoquick) : _origin(origin), _firstValidRow(firstValidRow), _autoquick(autoquick), _sortable(true), _asyncList(false), _loadingList(false)
 {
 	_screen = false;
 
@@ -177,9 +178,33 @@ void ListGamesState::init()
 		applyBattlescapeTheme("saveMenus");
 	}
 
+	// new or changed saves can be read in background, the rest is already known
+	_loadingList = !_game->getSaveIndex()->update(!_asyncList);
+	refreshList();
+}
+
+/**
+ * Shows saves that were read in background.
+ */
+void ListGamesState::think()
+{
+	State::think();
+
+	if (_loadingList && _game->getSaveIndex()->poll())
+	{
+		_loadingList = false;
+		refreshList();
+	}
+}
+
+/**
+ * Rebuilds the saves list from the save index.
+ */
+void ListGamesState::refreshList()
+{
 	try
 	{
-		_saves = SavedGame::getList(_game->getLanguage(), _autoquick);
+		_saves = SavedGame::getList(*_game->getSaveIndex(), _game->getLanguage(), _autoquick);
 		_lstSaves->clearList();
 		sortList(Options::saveOrder);
 	}
@@ -48,8 +48,11 @@ protected:
 	std::vector<SaveInfo> _saves;
 	unsigned int _firstValidRow;
 	bool _autoquick, _sortable;
+	bool _asyncList, _loadingList;
 
 	void updateArrows();
+	/// Rebuilds the saves list from the save index.
+	void refreshList();
 public:
 	/// Creates the Saved Game state.
 	ListGamesState(OptionsOrigin origin, int firstValidRow, bool autoquick);
@@ -57,6 +60,8 @@ public:
 	virtual ~ListGamesState();
 	/// Sets up the saves list.
 	void init() override;
+	/// Shows saves read in background.
+	void think() override;
 	/// Sorts the savegame list.
 	void sortList(SaveSort sort);
 	/// Updates the savegame list.
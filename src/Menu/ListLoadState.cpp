@@ -28,6 +28,7 @@
 #include "ConfirmLoadState.h"
 #include "LoadGameState.h"
 #include "ListLoadOriginalState.h"
+#include "../Savegame/SaveIndex.h"
 
 namespace OpenXcom
 {
@@ -39,6 +40,8 @@ namespace OpenXcom
  */
 ListLoadState::ListLoadState(OptionsOrigin origin) : ListGamesState(origin, 0, true)
 {
+	_asyncList = true;
+
 	// Create objects
 	_btnOld = new TextButton(80, 16, 60, 172);
 	_btnCancel->setX(180);
@@ -112,6 +115,13 @@ void ListLoadState::init()
 	{
 		// make it so that this fires only once
 		Options::expendLoadLastSave();
+		// needs all saves to find the latest one
+		if (_loadingList)
+		{
+			_loadingList = false;
+			_game->getSaveIndex()->update(true);
+			refreshList();
+		}
 		// find the absolutely latest save game including quick and autos
 		time_t timestamp = 0;
 		int idx = -1, i = 0;
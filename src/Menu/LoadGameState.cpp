@@ -24,6 +24,7 @@
 #include "../Engine/Exception.h"
 #include "../Engine/Options.h"
 #include "../Engine/CrossPlatform.h"
+#include "../Engine/SaveWriter.h"
 #include "../Engine/Screen.h"
 #include "../Engine/LocalizedText.h"
 #include "../Interface/Text.h"
@@ -162,7 +163,8 @@ void LoadGameState::think()
 		// Reset touch flags
 		_game->resetTouchButtonFlags();
 
-		// Load the game
+		// Load the game, an autosave could still be written in background
+		_game->getSaveWriter()->wait();
 		SavedGame *s = new SavedGame();
 		try
 		{
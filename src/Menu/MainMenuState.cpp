@@ -32,6 +32,7 @@
 #include "OptionsVideoState.h"
 #include "ModListState.h"
 #include "../Engine/Options.h"
+#include "../Savegame/SaveIndex.h"
 #include "../Engine/FileMap.h"
 #include "../Engine/SDL2Helpers.h"
 #include <fstream>
@@ -198,7 +199,7 @@ MainMenuState::MainMenuState(bool updateCheck)
 void MainMenuState::init()
 {
 	State::init();
-	if (Options::getLoadLastSave() && _game->getSavedGame()->getList(_game->getLanguage(), true).size() > 0)
+	if (Options::getLoadLastSave() && _game->getSaveIndex()->update(true) && !SavedGame::getList(*_game->getSaveIndex(), _game->getLanguage(), true).empty())
 	{
 		Log(LOG_INFO) << "Loading last saved game";
 		btnLoadClick(NULL);
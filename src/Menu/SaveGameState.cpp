@@ -24,12 +24,14 @@
 #include "../Engine/Options.h"
 #include "../Engine/Screen.h"
 #include "../Engine/CrossPlatform.h"
+#include "../Engine/SaveWriter.h"
 #include "../Engine/LocalizedText.h"
 #include "../Engine/Unicode.h"
 #include "../Interface/Text.h"
 #include "ErrorMessageState.h"
 #include "MainMenuState.h"
 #include "../Savegame/SavedGame.h"
+#include "../Savegame/SaveIndex.h"
 #include "../Mod/Mod.h"
 #include "../Mod/RuleInterface.h"
 
@@ -165,16 +167,32 @@ void SaveGameState::think()
 			break;
 		}
 
+		// Simulations must not overwrite the player's saves
+		if (Options::isHeadless())
+		{
+			return;
+		}
+
 		// Save the game
 		try
 		{
-			std::string backup = _filename + ".bak";
-			_game->getSavedGame()->save(backup, _game->getMod());
 			std::string fullPath = Options::getMasterUserFolder() + _filename;
-			std::string bakPath = Options::getMasterUserFolder() + backup;
-			if (!CrossPlatform::moveFile(bakPath, fullPath))
+			if (Options::autosaveInBackground && (_type == SAVE_AUTO_GEOSCAPE || _type == SAVE_AUTO_BATTLESCAPE))
+			{
+				// only the snapshot is taken here, writing it is done by another thread
+				_game->getSaveWriter()->write(fullPath, _game->getSavedGame()->snapshot(_game->getMod()), Options::saveBinary);
+			}
+			else
 			{
-				throw Exception("Save backed up in " + backup);
+				_game->getSaveWriter()->wait();
+				std::string backup = _filename + ".bak";
+				_game->getSavedGame()->save(backup, _game->getMod());
+				std::string bakPath = Options::getMasterUserFolder() + backup;
+				if (!CrossPlatform::moveFile(bakPath, fullPath))
+				{
+					throw Exception("Save backed up in " + backup);
+				}
+				_game->getSaveIndex()->refreshFile(_filename);
 			}
 
 			if (_type == SAVE_IRONMAN_END)
@@ -35,6 +35,8 @@
 #include "../Interface/Text.h"
 #include "MainMenuState.h"
 #include "CutsceneState.h"
+#include "../Battlescape/BattleSimulation.h"
+#include "../Geoscape/GeoscapeSimulation.h"
 #include <SDL_mixer.h>
 #include <SDL_thread.h>
 
@@ -170,10 +172,24 @@ void StartState::think()
 		addLine("");
 		addLine("Press any key to continue.");
 		loading = LOADING_DONE;
+		if (Options::isHeadless())
+		{
+			_game->quit();
+		}
 		break;
 	case LOADING_SUCCESSFUL:
 		CrossPlatform::flashWindow();
 		Log(LOG_INFO) << "OpenXcom started successfully!";
+		if (!Options::getSimulateBattle().empty())
+		{
+			BattleSimulation::start(_game, Options::getSimulateBattle(), Options::getSimulateTurns());
+			break;
+		}
+		if (!Options::getSimulateGeoscape().empty())
+		{
+			GeoscapeSimulation::start(_game, Options::getSimulateGeoscape(), Options::getSimulateDays());
+			break;
+		}
 		_game->setState(new GoToMainMenuState(false));
 		if (_oldMaster != Options::getActiveMaster() && Options::playIntro)
 		{
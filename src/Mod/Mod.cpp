@@ -22,6 +22,7 @@
 #include <sstream>
 #include <climits>
 #include <cassert>
+#include <chrono>
 #include "../Engine/CrossPlatform.h"
 #include "../Engine/FileMap.h"
 #include "../Engine/Palette.h"
@@ -45,6 +46,7 @@
 #include "SoundDefinition.h"
 #include "ExtraSprites.h"
 #include "CustomPalettes.h"
+#include "RulesetLoader.h"
 #include "ExtraSounds.h"
 #include "../Engine/AdlibMusic.h"
 #include "../Engine/CatFile.h"
@@ -2079,6 +2081,8 @@ void Mod::loadAll()
 	_soundOffsetGeo = _sounds["GEO.CAT"]->getMaxSharedSounds();
 
 	Log(LOG_INFO) << "Loading rulesets...";
+	// parsing of YAML can be done in background or skipped thanks to cache, only applying it to rules need be done in order
+	RulesetLoader loader(Options::rulesetParseThreads, Options::rulesetCache);
 	// load rest rulesets
 	for (size_t i = 0; mods.size() > i; ++i)
 	{
@@ -2086,7 +2090,7 @@ void Mod::loadAll()
 		{
 			_modCurrent = &_modData.at(i);
 			_scriptGlobal->setMod((int)_modCurrent->offset);
-			loadMod(mods[i].second, parser);
+			loadMod(mods[i].second, parser, loader);
 		}
 		catch (Exception &e)
 		{
@@ -2094,6 +2098,7 @@ void Mod::loadAll()
 			throwModOnErrorHelper(modId, e.what());
 		}
 	}
+	loader.finish();
 	Log(LOG_INFO) << "Loading rulesets done.";
 
 	//back master
@@ -2301,23 +2306,30 @@ void Mod::loadAll()
  * mod loaded should be the master at index 0, then 1, and so on.
  * @param rulesetFiles List of rulesets to load.
  * @param parsers Object with all available parsers.
+ * @param loader Source of parsed ruleset documents.
  */
-void Mod::loadMod(const std::vector<FileMap::FileRecord> &rulesetFiles, ModScript &parsers)
+void Mod::loadMod(const std::vector<FileMap::FileRecord> &rulesetFiles, ModScript &parsers, RulesetLoader &loader)
 {
-	for (auto i = rulesetFiles.begin(); i != rulesetFiles.end(); ++i)
+	loader.start(rulesetFiles);
+	for (size_t n = 0; n < rulesetFiles.size(); ++n)
 	{
-		Log(LOG_VERBOSE) << "- " << i->fullpath;
+		const FileMap::FileRecord &file = rulesetFiles[n];
+		Log(LOG_VERBOSE) << "- " << file.fullpath;
 		try
 		{
-			loadFile(*i, parsers);
+			YAML::Node doc = loader.get(n);
+
+			auto start = std::chrono::steady_clock::now();
+			loadFile(doc, parsers);
+			loader.applied(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
 		}
 		catch (Exception &e)
 		{
-			throw Exception(i->fullpath + ": " + std::string(e.what()));
+			throw Exception(file.fullpath + ": " + std::string(e.what()));
 		}
 		catch (YAML::Exception &e)
 		{
-			throw Exception(i->fullpath + ": " + std::string(e.what()));
+			throw Exception(file.fullpath + ": " + std::string(e.what()));
 		}
 	}
 
@@ -2491,15 +2503,13 @@ void Mod::loadConstants(const YAML::Node &node)
 }
 
 /**
- * Loads a ruleset's contents from a YAML file.
+ * Loads a ruleset's contents from a parsed YAML file.
  * Rules that match pre-existing rules overwrite them.
- * @param filename YAML filename.
+ * @param doc YAML document of the ruleset file.
  * @param parsers Object with all available parsers.
  */
-void Mod::loadFile(const FileMap::FileRecord &filerec, ModScript &parsers)
+void Mod::loadFile(YAML::Node &doc, ModScript &parsers)
 {
-	auto doc = filerec.getYAML();
-
 	if (const YAML::Node &extended = doc["extended"])
 	{
 		_scriptGlobal->load(extended);
@@ -0,0 +1,309 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RulesetLoader.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include "../Engine/ThreadPool.h"
+#include "../Engine/YamlBinary.h"
+#include "../Engine/CrossPlatform.h"
+#include "../Engine/Options.h"
+#include "../Engine/Logger.h"
+#include "../Engine/Exception.h"
+#include "../md5.h"
+#include "../version.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+using Millis = std::chrono::duration<double, std::milli>;
+
+/// Bump when format of cache file or YamlBinary changes.
+const size_t CacheFormatVersion = 1;
+const std::string CacheMagic = "OXCE-RULESET-CACHE";
+
+}
+
+/**
+ * Creates the loader.
+ * @param threads Number of parse threads, 0 parse on the calling thread, negative use all cores.
+ * @param useCache Reuse documents from the binary cache file and update it when done.
+ */
+RulesetLoader::RulesetLoader(int threads, bool useCache) : _files(nullptr), _useCache(useCache), _cacheHits(0), _cacheMisses(0)
+{
+	if (threads != 0)
+	{
+		_pool = std::make_unique<ThreadPool>(ThreadPool::getThreadCount(threads));
+		Log(LOG_INFO) << "Parsing rulesets using " << _pool->size() << " threads";
+	}
+	if (_useCache)
+	{
+		_cachePath = Options::getMasterUserFolder() + "rulesets.cache";
+		loadCache();
+	}
+}
+
+/**
+ * Waits for all workers, they could still use the cache.
+ */
+RulesetLoader::~RulesetLoader()
+{
+	_pool.reset();
+}
+
+/**
+ * Reads the cache file, any problem with it only means that everything will be parsed again.
+ */
+void RulesetLoader::loadCache()
+{
+	std::vector<unsigned char> data;
+	if (!CrossPlatform::readFile(_cachePath, data))
+	{
+		return;
+	}
+	try
+	{
+		const unsigned char *pos = data.data();
+		const unsigned char *end = pos + data.size();
+		if (YamlBinary::readString(pos, end) != CacheMagic ||
+			YamlBinary::readSize(pos, end) != CacheFormatVersion ||
+			YamlBinary::readString(pos, end) != OPENXCOM_VERSION_LONG)
+		{
+			Log(LOG_INFO) << "Ruleset cache is outdated, rebuilding";
+			return;
+		}
+		size_t count = YamlBinary::readSize(pos, end);
+		for (size_t i = 0; i < count; ++i)
+		{
+			std::string hash = YamlBinary::readString(pos, end);
+			size_t size = YamlBinary::readSize(pos, end);
+			if ((size_t)(end - pos) < size)
+			{
+				throw Exception("unexpected end of file");
+			}
+			_cache[hash].assign(pos, pos + size);
+			pos += size;
+		}
+	}
+	catch (Exception &e)
+	{
+		Log(LOG_WARNING) << "Ignoring broken ruleset cache " << _cachePath << ": " << e.what();
+		_cache.clear();
+	}
+}
+
+/**
+ * Writes the cache file, only entries used in this run are kept.
+ */
+void RulesetLoader::saveCache() const
+{
+	std::vector<unsigned char> data;
+	YamlBinary::writeString(data, CacheMagic);
+	YamlBinary::writeSize(data, CacheFormatVersion);
+	YamlBinary::writeString(data, OPENXCOM_VERSION_LONG);
+	YamlBinary::writeSize(data, _cacheUsed.size());
+	for (auto& hash : _cacheUsed)
+	{
+		auto i = _cacheNew.find(hash);
+		const std::vector<unsigned char> &binary = (i != _cacheNew.end()) ? i->second : _cache.at(hash);
+		YamlBinary::writeString(data, hash);
+		YamlBinary::writeSize(data, binary.size());
+		data.insert(data.end(), binary.begin(), binary.end());
+	}
+	if (!CrossPlatform::writeFile(_cachePath, data))
+	{
+		Log(LOG_WARNING) << "Failed to write ruleset cache " << _cachePath;
+	}
+}
+
+/**
+ * Reads the next file on this thread (zip archives can't be accessed concurrently)
+ * and queues turning it into a document, on the pool if there is one.
+ */
+void RulesetLoader::queueNext()
+{
+	const FileMap::FileRecord &file = _files->at(_pending.size());
+	std::shared_ptr<std::string> content;
+	try
+	{
+		std::ostringstream buffer;
+		buffer << file.getIStream()->rdbuf();
+		content = std::make_shared<std::string>(buffer.str());
+	}
+	catch (...)
+	{
+		// report error when it's the turn of this file
+		std::promise<Result> failed;
+		failed.set_exception(std::current_exception());
+		_pending.push_back(failed.get_future());
+		return;
+	}
+
+	const Cache *cache = _useCache ? &_cache : nullptr;
+	auto job = [content, cache]
+	{
+		auto start = Clock::now();
+		Result r;
+		bool cached = false;
+		if (cache)
+		{
+			r.hash = MD5(*content).hexdigest();
+			auto i = cache->find(r.hash);
+			if (i != cache->end())
+			{
+				try
+				{
+					r.doc = YamlBinary::read(i->second);
+					cached = true;
+				}
+				catch (Exception &)
+				{
+					// broken entry, parse it again
+				}
+			}
+		}
+		if (!cached)
+		{
+			r.doc = YAML::Load(*content);
+			if (cache)
+			{
+				YamlBinary::write(r.binary, r.doc);
+			}
+		}
+		r.parse = Millis(Clock::now() - start).count();
+		return r;
+	};
+
+	if (_pool)
+	{
+		_pending.push_back(_pool->submit(std::move(job)));
+	}
+	else
+	{
+		std::packaged_task<Result()> task(std::move(job));
+		_pending.push_back(task.get_future());
+		task();
+	}
+}
+
+/**
+ * Sets list of files for the next mod.
+ * @param files Ruleset files of the mod.
+ */
+void RulesetLoader::start(const std::vector<FileMap::FileRecord> &files)
+{
+	_pending.clear();
+	_files = &files;
+}
+
+/**
+ * Gets document of the n-th file of the current mod, waiting for it if still being parsed.
+ * Files after it are queued ahead, how far depends on the number of threads,
+ * as every parsed document waiting for its turn uses memory.
+ * @param n Index of the file, need be called with 0, 1, 2, ...
+ * @return Document of the file, or rethrows the error of reading/parsing it.
+ */
+YAML::Node RulesetLoader::get(size_t n)
+{
+	const size_t ahead = _pool ? 4 * _pool->size() : 0;
+	while (_pending.size() < _files->size() && _pending.size() <= n + ahead)
+	{
+		queueNext();
+	}
+
+	Result r;
+	try
+	{
+		// errors of reading or parsing on a worker are rethrown here
+		r = _pending.at(n).get();
+	}
+	catch (...)
+	{
+		Log(LOG_FATAL) << "Error loading file '" << _files->at(n).fullpath << "'";
+		throw;
+	}
+	if (_useCache)
+	{
+		if (r.binary.empty())
+		{
+			++_cacheHits;
+		}
+		else
+		{
+			++_cacheMisses;
+			_cacheNew.emplace(r.hash, std::move(r.binary));
+		}
+		_cacheUsed.insert(r.hash);
+	}
+	_timings.push_back({ _files->at(n).fullpath, r.parse, 0.0 });
+	return r.doc;
+}
+
+/**
+ * Records time spent on applying the last document to rules.
+ * @param ms Time in milliseconds.
+ */
+void RulesetLoader::applied(double ms)
+{
+	if (!_timings.empty())
+	{
+		_timings.back().apply = ms;
+	}
+}
+
+/**
+ * Stops workers, updates cache file if anything changed and logs statistics.
+ */
+void RulesetLoader::finish()
+{
+	_pool.reset();
+	_pending.clear();
+
+	if (_useCache)
+	{
+		Log(LOG_INFO) << "Ruleset cache: " << _cacheHits << " hits, " << _cacheMisses << " misses";
+		if (_cacheMisses > 0 || _cacheUsed.size() != _cache.size())
+		{
+			saveCache();
+		}
+	}
+
+	if (Options::rulesetLoadTimings)
+	{
+		double totalParse = 0.0, totalApply = 0.0;
+		for (auto& t : _timings)
+		{
+			totalParse += t.parse;
+			totalApply += t.apply;
+		}
+		std::stable_sort(_timings.begin(), _timings.end(), [](const LoadTime& a, const LoadTime& b){ return a.parse + a.apply > b.parse + b.apply; });
+
+		Log(LOG_INFO) << "Ruleset load times (parse ms / apply ms), " << _timings.size() << " files, total " << totalParse << " / " << totalApply << ":";
+		for (auto& t : _timings)
+		{
+			Log(LOG_INFO) << "  " << t.parse << " / " << t.apply << "  " << t.path;
+		}
+	}
+}
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+#include <unordered_map>
+#include <unordered_set>
+#include <yaml-cpp/yaml.h>
+#include "../Engine/FileMap.h"
+
+namespace OpenXcom
+{
+
+class ThreadPool;
+
+/**
+ * Turns ruleset files into YAML documents for Mod::loadAll.
+ * Files can be parsed ahead on worker threads and documents can be reused
+ * from a binary cache of previous runs (keyed by md5 of file content),
+ * but they are always handed out in file order.
+ */
+class RulesetLoader
+{
+public:
+	/// Time spent on one ruleset file.
+	struct LoadTime
+	{
+		/// Full path of ruleset file
+		std::string path;
+		/// Time of YAML parsing (or reading from cache) in milliseconds
+		double parse;
+		/// Time of applying parsed data to rules in milliseconds
+		double apply;
+	};
+
+private:
+	/// Document made from one file.
+	struct Result
+	{
+		YAML::Node doc;
+		double parse = 0.0;
+		std::string hash;
+		/// Binary form of newly parsed document, empty on cache hit.
+		std::vector<unsigned char> binary;
+	};
+	typedef std::unordered_map<std::string, std::vector<unsigned char>> Cache;
+
+	std::unique_ptr<ThreadPool> _pool;
+	const std::vector<FileMap::FileRecord> *_files;
+	std::vector<std::future<Result>> _pending;
+	std::vector<LoadTime> _timings;
+
+	bool _useCache;
+	std::string _cachePath;
+	/// Entries loaded from cache file, read only while loading as workers use it.
+	Cache _cache;
+	/// Entries created in this run.
+	Cache _cacheNew;
+	/// Hashes of all files loaded in this run.
+	std::unordered_set<std::string> _cacheUsed;
+	size_t _cacheHits, _cacheMisses;
+
+	/// Reads the cache file.
+	void loadCache();
+	/// Writes the cache file with entries used in this run.
+	void saveCache() const;
+	/// Reads next file and queues its parsing.
+	void queueNext();
+public:
+	/// Creates loader with given number of parse threads and optional cache.
+	RulesetLoader(int threads, bool useCache);
+	/// Cleans up the loader.
+	~RulesetLoader();
+	/// Sets list of files for the next mod.
+	void start(const std::vector<FileMap::FileRecord> &files);
+	/// Gets document of the n-th file, files need be taken in order.
+	YAML::Node get(size_t n);
+	/// Records time spent on applying the last document.
+	void applied(double ms);
+	/// Updates cache file and logs statistics.
+	void finish();
+};
+
+}
@@ -2479,6 +2479,25 @@ bool BattleUnit::addToVisibleTiles(Tile *tile)
 	return false;
 }
 
+/**
+ * Removes a tile from the list of visible tiles.
+ * @param tile The tile to remove.
+ * @return True when the tile was on the list.
+ */
+bool BattleUnit::removeFromVisibleTiles(Tile *tile)
+{
+	if (!_visibleTilesLookup.erase(tile))
+	{
+		return false;
+	}
+	tile->setVisible(-1);
+	std::vector<Tile*>::iterator i = std::find(_visibleTiles.begin(), _visibleTiles.end(), tile);
+	//Slow to remove stuff from vector as it shuffles all the following items. Swap in rearmost element before removal.
+	(*i) = *(_visibleTiles.end() - 1);
+	_visibleTiles.pop_back();
+	return true;
+}
+
 /**
  * Get the pointer to the vector of visible tiles.
  * @return pointer to vector.
@@ -3441,11 +3460,24 @@ void BattleUnit::updateTileFloorState(SavedBattleGame *saveBattleGame)
  */
 void BattleUnit::setTile(Tile *tile, SavedBattleGame *saveBattleGame)
 {
+	// done before the early exit: `setInventoryTile` changes `_tile` without touching the grid,
+	// so this can be the call that places the unit in the grid even when the tile is unchanged
+	if (saveBattleGame)
+	{
+		saveBattleGame->updateUnitGrid(this, tile);
+	}
+
 	if (_tile == tile)
 	{
 		return;
 	}
 
+	// other units can path through old tile but not the new one
+	if (saveBattleGame && saveBattleGame->getPathfinding())
+	{
+		saveBattleGame->getPathfinding()->invalidateReachable();
+	}
+
 	auto armorSize = _armor->getSize() - 1;
 	// Reset tiles moved from.
 	if (_tile)
@@ -3508,7 +3540,8 @@ void BattleUnit::setTile(Tile *tile, SavedBattleGame *saveBattleGame)
 /**
  * Set only unit tile without any additional logic.
  * Used only in before battle, other wise will break game.
- * Need call setTile after to fix links
+ * Need call setTile after to fix links, this also includes the unit grid
+ * of SavedBattleGame, which keeps the unit where it last got by setTile.
  * @param tile
  */
 void BattleUnit::setInventoryTile(Tile *tile)
@@ -398,6 +398,8 @@ public:
 	void clearVisibleUnits();
 	/// Add unit to visible tiles.
 	bool addToVisibleTiles(Tile *tile);
+	/// Remove tile from visible tiles list.
+	bool removeFromVisibleTiles(Tile *tile);
 	/// Has this unit marked this tile as within its view?
 	bool hasVisibleTile(Tile *tile) const
 	{
@@ -0,0 +1,296 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SaveIndex.h"
+#include <set>
+#include "../Engine/ThreadPool.h"
+#include "../Engine/BinarySave.h"
+#include "../Engine/YamlBinary.h"
+#include "../Engine/CrossPlatform.h"
+#include "../Engine/Options.h"
+#include "../Engine/Logger.h"
+#include "../Engine/Exception.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+/// Bump when layout of index file or YamlBinary changes.
+const size_t IndexFormatVersion = 1;
+const std::string IndexMagic = "OXCE-SAVE-INDEX";
+const std::string IndexFilename = "saves.index";
+
+/**
+ * Reads the header of one save, safe to run on a worker thread.
+ * @param folder Folder with the save.
+ * @param filename Save filename.
+ * @return Index entry, with error message if the header is broken.
+ */
+SaveIndex::Entry readEntry(const std::string &folder, const std::string &filename)
+{
+	SaveIndex::Entry entry;
+	std::string path = folder + filename;
+	entry.timestamp = CrossPlatform::getDateModified(path);
+	entry.size = CrossPlatform::getFileSize(path);
+	try
+	{
+		entry.header = BinarySave::loadHeader(path);
+	}
+	catch (std::exception &e)
+	{
+		entry.error = e.what();
+	}
+	return entry;
+}
+
+}
+
+/**
+ * Creates an empty index, it's filled on first update.
+ */
+SaveIndex::SaveIndex()
+{
+}
+
+/**
+ * Waits for the background scan, it uses the worker thread.
+ */
+SaveIndex::~SaveIndex()
+{
+	_thread.reset();
+}
+
+/**
+ * Reads the index file of the current folder.
+ * Any problem with it only means that all headers will be read again.
+ */
+void SaveIndex::load()
+{
+	_entries.clear();
+	std::string path = _folder + IndexFilename;
+	if (!CrossPlatform::fileExists(path))
+	{
+		return;
+	}
+	std::vector<unsigned char> data;
+	if (!CrossPlatform::readFile(path, data))
+	{
+		return;
+	}
+	try
+	{
+		const unsigned char *pos = data.data();
+		const unsigned char *end = pos + data.size();
+		if (YamlBinary::readString(pos, end) != IndexMagic || YamlBinary::readSize(pos, end) != IndexFormatVersion)
+		{
+			return;
+		}
+		size_t count = YamlBinary::readSize(pos, end);
+		for (size_t i = 0; i < count; ++i)
+		{
+			std::string filename = YamlBinary::readString(pos, end);
+			Entry &entry = _entries[filename];
+			entry.timestamp = (time_t)YamlBinary::readSize(pos, end);
+			entry.size = YamlBinary::readSize(pos, end);
+			entry.error = YamlBinary::readString(pos, end);
+			if (entry.error.empty())
+			{
+				entry.header = YamlBinary::read(pos, end);
+			}
+		}
+	}
+	catch (Exception &e)
+	{
+		Log(LOG_WARNING) << "Ignoring broken save index " << path << ": " << e.what();
+		_entries.clear();
+	}
+}
+
+/**
+ * Writes the index file of the current folder.
+ */
+void SaveIndex::save() const
+{
+	std::vector<unsigned char> data;
+	YamlBinary::writeString(data, IndexMagic);
+	YamlBinary::writeSize(data, IndexFormatVersion);
+	YamlBinary::writeSize(data, _entries.size());
+	for (auto& i : _entries)
+	{
+		YamlBinary::writeString(data, i.first);
+		YamlBinary::writeSize(data, (size_t)i.second.timestamp);
+		YamlBinary::writeSize(data, (size_t)i.second.size);
+		YamlBinary::writeString(data, i.second.error);
+		if (i.second.error.empty())
+		{
+			YamlBinary::write(data, i.second.header);
+		}
+	}
+	std::string path = _folder + IndexFilename;
+	if (!CrossPlatform::writeFile(path, data))
+	{
+		Log(LOG_WARNING) << "Failed to write save index " << path;
+	}
+}
+
+/**
+ * Adds freshly read headers to the index and stores it.
+ * @param folder Folder the headers were read from.
+ * @param results Read headers.
+ */
+void SaveIndex::merge(const std::string &folder, const Results &results)
+{
+	if (folder != _folder)
+	{
+		// master mod was switched in the meantime
+		return;
+	}
+	for (auto& i : results)
+	{
+		if (!i.second.error.empty())
+		{
+			Log(LOG_ERROR) << i.first << ": " << i.second.error;
+		}
+		_entries[i.first] = i.second;
+	}
+	save();
+}
+
+/**
+ * Brings the index up to date with the save folder of the current master mod.
+ * Headers of new and changed saves are read again, removed saves are dropped.
+ * @param wait Read headers on this thread, otherwise they are read in background.
+ * @return True when the index is complete, false when a background scan is running.
+ */
+bool SaveIndex::update(bool wait)
+{
+	if (_pending.valid())
+	{
+		if (!wait)
+		{
+			return poll();
+		}
+		merge(_pendingFolder, _pending.get());
+	}
+
+	std::string folder = Options::getMasterUserFolder();
+	if (folder != _folder)
+	{
+		_folder = folder;
+		load();
+	}
+
+	auto files = CrossPlatform::getFolderContents(_folder, "sav");
+	auto autoFiles = CrossPlatform::getFolderContents(_folder, "asav");
+	files.insert(files.end(), autoFiles.begin(), autoFiles.end());
+
+	std::set<std::string> present;
+	std::vector<std::string> changed;
+	for (auto& file : files)
+	{
+		const std::string &filename = std::get<0>(file);
+		present.insert(filename);
+		auto i = _entries.find(filename);
+		if (i == _entries.end() ||
+			i->second.timestamp != std::get<2>(file) ||
+			i->second.size != CrossPlatform::getFileSize(_folder + filename))
+		{
+			changed.push_back(filename);
+		}
+	}
+	bool removed = false;
+	for (auto i = _entries.begin(); i != _entries.end();)
+	{
+		if (present.find(i->first) == present.end())
+		{
+			i = _entries.erase(i);
+			removed = true;
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	if (changed.empty())
+	{
+		if (removed)
+		{
+			save();
+		}
+		return true;
+	}
+
+	auto job = [folder, changed]
+	{
+		Results results;
+		for (auto& filename : changed)
+		{
+			results.push_back(std::make_pair(filename, readEntry(folder, filename)));
+		}
+		return results;
+	};
+	if (wait)
+	{
+		merge(folder, job());
+		return true;
+	}
+	if (!_thread)
+	{
+		_thread = std::make_unique<ThreadPool>(1);
+	}
+	_pendingFolder = folder;
+	_pending = _thread->submit(job);
+	return false;
+}
+
+/**
+ * Checks if the background scan has finished, without blocking.
+ * @return True when the index is complete.
+ */
+bool SaveIndex::poll()
+{
+	if (!_pending.valid())
+	{
+		return true;
+	}
+	if (_pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	{
+		return false;
+	}
+	merge(_pendingFolder, _pending.get());
+	return true;
+}
+
+/**
+ * Reads the header of a single save again, used right after saving.
+ * @param filename Save filename in the current master user folder.
+ */
+void SaveIndex::refreshFile(const std::string &filename)
+{
+	if (_folder != Options::getMasterUserFolder())
+	{
+		// not scanned yet, the next update reads everything anyway
+		return;
+	}
+	merge(_folder, Results{ std::make_pair(filename, readEntry(_folder, filename)) });
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <ctime>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+namespace OpenXcom
+{
+
+class ThreadPool;
+
+/**
+ * Persistent index of save file headers in the master user folder.
+ * Only files that were added or changed since the last scan (by modification time
+ * or size) have their header read again, optionally on a background thread.
+ */
+class SaveIndex
+{
+public:
+	/// Cached header of one save file.
+	struct Entry
+	{
+		time_t timestamp = 0;
+		uint64_t size = 0;
+		YAML::Node header;
+		std::string error;
+	};
+	typedef std::map<std::string, Entry> Entries;
+private:
+	typedef std::vector<std::pair<std::string, Entry>> Results;
+
+	std::string _folder;
+	Entries _entries;
+	std::unique_ptr<ThreadPool> _thread;
+	std::future<Results> _pending;
+	std::string _pendingFolder;
+
+	/// Reads the index file of the current folder.
+	void load();
+	/// Writes the index file of the current folder.
+	void save() const;
+	/// Adds freshly read headers to the index.
+	void merge(const std::string &folder, const Results &results);
+public:
+	/// Creates an empty index.
+	SaveIndex();
+	/// Waits for the background scan.
+	~SaveIndex();
+
+	SaveIndex(const SaveIndex&) = delete;
+	SaveIndex& operator=(const SaveIndex&) = delete;
+
+	/// Brings the index up to date with the save folder.
+	bool update(bool wait);
+	/// Checks if the background scan has finished.
+	bool poll();
+	/// Reads the header of a single save again.
+	void refreshFile(const std::string &filename);
+	/// Gets all indexed saves.
+	const Entries &getEntries() const { return _entries; }
+};
+
+}
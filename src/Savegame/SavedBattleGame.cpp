@@ -17,6 +17,8 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <assert.h>
+#include <algorithm>
+#include <chrono>
 #include <vector>
 #include "BattleItem.h"
 #include "ItemContainer.h"
@@ -65,7 +67,7 @@ namespace OpenXcom
  */
 SavedBattleGame::SavedBattleGame(Mod *rule, Language *lang, bool isPreview) :
 	_isPreview(isPreview), _craftPos(), _craftZ(0), _craftForPreview(nullptr),
-	_battleState(0), _rule(rule), _mapsize_x(0), _mapsize_y(0), _mapsize_z(0), _selectedUnit(0),
+	_battleState(0), _rule(rule), _mapsize_x(0), _mapsize_y(0), _mapsize_z(0), _unitGridSizeX(0), _selectedUnit(0),
 	_lastSelectedUnit(0), _pathfinding(0), _tileEngine(0),
 	_reinforcementsItemLevel(0), _startingCondition(nullptr), _enviroEffects(nullptr), _ecEnabledFriendly(false), _ecEnabledHostile(false), _ecEnabledNeutral(false),
 	_globalShade(0), _side(FACTION_PLAYER), _turn(0), _bughuntMinTurn(20), _animFrame(0), _nameDisplay(false),
@@ -704,12 +706,144 @@ void SavedBattleGame::initMap(int mapsize_x, int mapsize_y, int mapsize_z, bool
 	_mapsize_z = mapsize_z;
 
 	_tiles.clear();
+	_tileLayers.assign(_mapsize_z * _mapsize_y * _mapsize_x);
 	_tiles.reserve(_mapsize_z * _mapsize_y * _mapsize_x);
 	for (int i = 0; i < _mapsize_z * _mapsize_y * _mapsize_x; ++i)
 	{
 		_tiles.push_back(Tile(getTileCoords(i), this));
 	}
+	_terrainVoxels.assign(_tiles.size() * TerrainVoxelLayers * O_MAX, NoTerrainVoxels);
 
+	_unitGridSizeX = (_mapsize_x + UnitGridCellSize - 1) / UnitGridCellSize;
+	_unitGrid.clear();
+	_unitGrid.resize(_unitGridSizeX * ((_mapsize_y + UnitGridCellSize - 1) / UnitGridCellSize));
+	_unitGridCell.clear();
+	_unitIndex.clear();
+}
+
+/**
+ * Updates loft IDs of terrain parts of a tile, called every time terrain or door state of the tile changes.
+ * @param tile The changed tile.
+ */
+void SavedBattleGame::updateTerrainVoxels(const Tile *tile)
+{
+	Uint16 *lofts = &_terrainVoxels[getTileIndex(tile->getPosition()) * TerrainVoxelLayers * O_MAX];
+	for (int i = O_FLOOR; i < O_MAX; ++i)
+	{
+		TilePart tp = (TilePart)i;
+		MapData *mp = tile->getMapData(tp);
+		if (((tp == O_WESTWALL) || (tp == O_NORTHWALL)) && tile->isUfoDoorOpen(tp))
+		{
+			mp = nullptr;
+		}
+		for (int layer = 0; layer < TerrainVoxelLayers; ++layer)
+		{
+			lofts[layer * O_MAX + i] = mp ? (Uint16)mp->getLoftID(layer) : NoTerrainVoxels;
+		}
+	}
+}
+
+/**
+ * Moves a unit to the unit grid cell of the tile it stands on, called every time the unit's tile changes.
+ * @param unit The unit.
+ * @param tile The new tile of the unit, or null if it left the map.
+ */
+void SavedBattleGame::updateUnitGrid(const BattleUnit *unit, const Tile *tile)
+{
+	int cell = -1;
+	if (tile && !_unitGrid.empty())
+	{
+		Position pos = tile->getPosition();
+		cell = (pos.y / UnitGridCellSize) * _unitGridSizeX + pos.x / UnitGridCellSize;
+	}
+
+	auto prev = _unitGridCell.find(unit);
+	int prevCell = prev != _unitGridCell.end() ? prev->second : -1;
+	if (prevCell == cell)
+	{
+		return;
+	}
+	if (prevCell != -1)
+	{
+		auto &bucket = _unitGrid[prevCell];
+		bucket.erase(std::find(bucket.begin(), bucket.end(), unit));
+		_unitGridCell.erase(prev);
+	}
+	if (cell != -1)
+	{
+		_unitGrid[cell].push_back(const_cast<BattleUnit*>(unit));
+		_unitGridCell[unit] = cell;
+	}
+}
+
+/**
+ * Gets units standing on tiles within a given horizontal range of a position (and some more, as whole grid cells are checked).
+ * Units are returned in the same order as in the unit list, using an index of the list
+ * that is built again only when units were added or removed.
+ * @param pos Center position.
+ * @param range Range in tiles.
+ * @param units Vector to fill with units.
+ */
+void SavedBattleGame::getUnitsInRange(Position pos, int range, std::vector<BattleUnit*> &units) const
+{
+	units.clear();
+	if (_unitGrid.empty())
+	{
+		return;
+	}
+	const int sizeY = (int)_unitGrid.size() / _unitGridSizeX;
+	const int minX = std::max(0, (pos.x - range) / UnitGridCellSize);
+	const int maxX = std::min(_unitGridSizeX - 1, (pos.x + range) / UnitGridCellSize);
+	const int minY = std::max(0, (pos.y - range) / UnitGridCellSize);
+	const int maxY = std::min(sizeY - 1, (pos.y + range) / UnitGridCellSize);
+	for (int y = minY; y <= maxY; ++y)
+	{
+		for (int x = minX; x <= maxX; ++x)
+		{
+			const auto &bucket = _unitGrid[y * _unitGridSizeX + x];
+			units.insert(units.end(), bucket.begin(), bucket.end());
+		}
+	}
+
+	// keep order of the unit list, results should not depend on the way units moved around the map
+	if (units.size() > 1)
+	{
+		std::vector<std::pair<int, BattleUnit*>> ordered;
+		ordered.reserve(units.size());
+		auto collect = [&](bool rebuilt)
+		{
+			ordered.clear();
+			for (BattleUnit *bu : units)
+			{
+				auto index = _unitIndex.find(bu);
+				if (index != _unitIndex.end() && index->second < (int)_units.size() && _units[index->second] == bu)
+				{
+					ordered.push_back(std::make_pair(index->second, bu));
+				}
+				else if (!rebuilt)
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+		if (!collect(false))
+		{
+			// units were added or removed since the index was built
+			_unitIndex.clear();
+			for (int i = 0; i < (int)_units.size(); ++i)
+			{
+				_unitIndex[_units[i]] = i;
+			}
+			collect(true);
+		}
+		std::sort(ordered.begin(), ordered.end());
+		for (size_t i = 0; i < ordered.size(); ++i)
+		{
+			units[i] = ordered[i].second;
+		}
+		units.resize(ordered.size());
+	}
 }
 
 /**
@@ -1571,6 +1705,15 @@ const RuleCraftDeployment& SavedBattleGame::getCustomDeployment(const RuleCraft*
  */
 void SavedBattleGame::endTurn()
 {
+	if (_pathfinding)
+	{
+		_pathfinding->endTurnReachable();
+	}
+	if (_tileEngine)
+	{
+		_tileEngine->endTurnFOV();
+	}
+
 	// reset turret direction for all hostile and neutral units (as it may have been changed during reaction fire)
 	for (std::vector<BattleUnit*>::iterator i = _units.begin(); i != _units.end(); ++i)
 	{
@@ -2434,13 +2577,16 @@ Node *SavedBattleGame::getPatrolNode(bool scout, BattleUnit *unit, Node *fromNod
  */
 void SavedBattleGame::prepareNewTurn()
 {
+	auto start = std::chrono::steady_clock::now();
+	const int size = getMapSizeXYZ();
 	std::vector<Tile*> tilesOnFire;
 	std::vector<Tile*> tilesOnSmoke;
 
 	// prepare a list of tiles on fire
-	for (int i = 0; i < _mapsize_x * _mapsize_y * _mapsize_z; ++i)
+	const Uint8 *fire = _tileLayers.fire.data();
+	for (int i = 0; i < size; ++i)
 	{
-		if (getTile(i)->getFire() > 0)
+		if (fire[i] > 0)
 		{
 			tilesOnFire.push_back(getTile(i));
 		}
@@ -2507,14 +2653,15 @@ void SavedBattleGame::prepareNewTurn()
 	}
 
 	// prepare a list of tiles on fire/with smoke in them (smoke acts as fire intensity)
-	for (int i = 0; i < _mapsize_x * _mapsize_y * _mapsize_z; ++i)
+	const Uint8 *smoke = _tileLayers.smoke.data();
+	for (int i = 0; i < size; ++i)
 	{
-		if (getTile(i)->getSmoke() > 0)
+		if (smoke[i] > 0)
 		{
 			tilesOnSmoke.push_back(getTile(i));
 		}
-		getTile(i)->setDangerous(false);
 	}
+	std::fill(_tileLayers.danger.begin(), _tileLayers.danger.end(), 0);
 
 	// now make the smoke spread.
 	for (std::vector<Tile*>::iterator i = tilesOnSmoke.begin(); i != tilesOnSmoke.end(); ++i)
@@ -2571,12 +2718,13 @@ void SavedBattleGame::prepareNewTurn()
 	if (!tilesOnFire.empty() || !tilesOnSmoke.empty())
 	{
 		// do damage to units, average out the smoke, etc.
-		for (int i = 0; i < _mapsize_x * _mapsize_y * _mapsize_z; ++i)
+		for (int i = 0; i < size; ++i)
 		{
-			if (getTile(i)->getSmoke() != 0)
+			if (smoke[i] != 0)
 				getTile(i)->prepareNewTurn(getDepth() == 0);
 		}
 	}
+	auto tilesDone = std::chrono::steady_clock::now();
 
 	Mod *mod = getBattleState()->getGame()->getMod();
 	for (std::vector<BattleUnit*>::iterator i = getUnits()->begin(); i != getUnits()->end(); ++i)
@@ -2584,6 +2732,11 @@ void SavedBattleGame::prepareNewTurn()
 		(*i)->calculateEnviDamage(mod, this);
 	}
 
+	auto end = std::chrono::steady_clock::now();
+	Log(LOG_DEBUG) << "New turn preparations: " << tilesOnFire.size() << " tiles on fire, " << tilesOnSmoke.size() << " with smoke, "
+		<< std::chrono::duration_cast<std::chrono::microseconds>(tilesDone - start).count() << "us tiles, "
+		<< std::chrono::duration_cast<std::chrono::microseconds>(end - tilesDone).count() << "us units";
+
 	//fov and light udadates are done in `BattlescapeGame::endTurn`
 }
 
@@ -19,6 +19,7 @@
  */
 #include <vector>
 #include <string>
+#include <unordered_map>
 #include <yaml-cpp/yaml.h>
 #include "Tile.h"
 #include "../Mod/AlienDeployment.h"
@@ -75,6 +76,12 @@ private:
 	int _mapsize_x, _mapsize_y, _mapsize_z;
 	std::vector<MapDataSet*> _mapDataSets;
 	std::vector<Tile> _tiles;
+	TileLayers _tileLayers;
+	std::vector<Uint16> _terrainVoxels;
+	std::vector<std::vector<BattleUnit*>> _unitGrid;
+	std::unordered_map<const BattleUnit*, int> _unitGridCell;
+	mutable std::unordered_map<const BattleUnit*, int> _unitIndex;
+	int _unitGridSizeX;
 	BattleUnit *_selectedUnit, *_lastSelectedUnit;
 	std::vector<Node*> _nodes;
 	std::vector<BattleUnit*> _units;
@@ -297,6 +304,38 @@ public:
 		return &_tiles[getTileIndex(pos)];
 	}
 
+	/// Gets frequently used fields of all tiles, indexed by tile index.
+	TileLayers &getTileLayers() { return _tileLayers; }
+	/// Gets frequently used fields of all tiles, indexed by tile index.
+	const TileLayers &getTileLayers() const { return _tileLayers; }
+
+	/// Number of voxel layers of terrain, each layer is two voxels high.
+	static constexpr int TerrainVoxelLayers = 12;
+	/// Loft ID of tile part that has no terrain voxels (missing part or open ufo door).
+	static constexpr Uint16 NoTerrainVoxels = 0xFFFF;
+
+	/**
+	 * Gets loft IDs of terrain parts of a tile at a given voxel layer.
+	 * Used by voxel checks instead of going through map data of every part.
+	 * @param index Index of the tile.
+	 * @param layer Voxel layer, 0 to TerrainVoxelLayers - 1.
+	 * @return Pointer to loft IDs of the four tile parts.
+	 */
+	inline const Uint16 *getTerrainVoxels(int index, int layer) const
+	{
+		return &_terrainVoxels[(index * TerrainVoxelLayers + layer) * O_MAX];
+	}
+
+	/// Updates loft IDs of terrain parts of a tile.
+	void updateTerrainVoxels(const Tile *tile);
+
+	/// Size in tiles of a cell of the unit grid.
+	static constexpr int UnitGridCellSize = 8;
+	/// Moves a unit to the unit grid cell of a tile.
+	void updateUnitGrid(const BattleUnit *unit, const Tile *tile);
+	/// Gets units standing near a position.
+	void getUnitsInRange(Position pos, int range, std::vector<BattleUnit*> &units) const;
+
 	/*
 	 * Gets a pointer to the tiles, a tile is the smallest component of battlescape.
 	 * @param pos Index position, less than `getMapSizeXYZ()`.
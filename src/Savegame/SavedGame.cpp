@@ -22,6 +22,7 @@
 #include <iomanip>
 #include <algorithm>
 #include <ctime>
+#include <chrono>
 #include <yaml-cpp/yaml.h>
 #include "../version.h"
 #include "../Engine/Logger.h"
@@ -30,6 +31,7 @@
 #include "../Engine/Exception.h"
 #include "../Engine/Options.h"
 #include "../Engine/CrossPlatform.h"
+#include "../Engine/BinarySave.h"
 #include "../Engine/ScriptBind.h"
 #include "../Engine/Game.h"
 #include "../FTA/MasterMind.h"
@@ -290,27 +292,25 @@ static bool _isCurrentGameType(const SaveInfo &saveInfo, const std::string &curM
 
 /**
  * Gets all the info of the saves found in the user folder.
+ * @param index Save headers, already brought up to date by the caller.
  * @param lang Loaded language.
  * @param autoquick Include autosaves and quicksaves.
  * @return List of saves info.
  */
-std::vector<SaveInfo> SavedGame::getList(Language *lang, bool autoquick)
+std::vector<SaveInfo> SavedGame::getList(const SaveIndex &index, Language *lang, bool autoquick)
 {
 	std::vector<SaveInfo> info;
 	std::string curMaster = Options::getActiveMaster();
-	auto saves = CrossPlatform::getFolderContents(Options::getMasterUserFolder(), "sav");
-
-	if (autoquick)
-	{
-		auto asaves = CrossPlatform::getFolderContents(Options::getMasterUserFolder(), "asav");
-		saves.insert(saves.begin(), asaves.begin(), asaves.end());
-	}
-	for (auto i = saves.begin(); i != saves.end(); ++i)
+	for (auto& i : index.getEntries())
 	{
-		auto filename = std::get<0>(*i);
+		const std::string &filename = i.first;
+		if (!i.second.error.empty() || (!autoquick && CrossPlatform::compareExt(filename, "asav")))
+		{
+			continue;
+		}
 		try
 		{
-			SaveInfo saveInfo = getSaveInfo(filename, lang);
+			SaveInfo saveInfo = getSaveInfo(filename, i.second.header, i.second.timestamp, lang);
 			if (!_isCurrentGameType(saveInfo, curMaster))
 			{
 				continue;
@@ -335,12 +335,12 @@ std::vector<SaveInfo> SavedGame::getList(Language *lang, bool autoquick)
 /**
  * Gets the info of a specific save file.
  * @param file Save filename.
+ * @param doc Brief info from the save header.
+ * @param timestamp Modification time of the save.
  * @param lang Loaded language.
  */
-SaveInfo SavedGame::getSaveInfo(const std::string &file, Language *lang)
+SaveInfo SavedGame::getSaveInfo(const std::string &file, const YAML::Node &doc, time_t timestamp, Language *lang)
 {
-	std::string fullname = Options::getMasterUserFolder() + file;
-	YAML::Node doc = YAML::Load(*CrossPlatform::getYamlSaveHeader(fullname));
 	SaveInfo save;
 
 	save.fileName = file;
@@ -383,7 +383,7 @@ SaveInfo SavedGame::getSaveInfo(const std::string &file, Language *lang)
 		save.reserved = false;
 	}
 
-	save.timestamp = CrossPlatform::getDateModified(fullname);
+	save.timestamp = timestamp;
 	std::pair<std::string, std::string> str = CrossPlatform::timeToString(save.timestamp);
 	save.isoDate = str.first;
 	save.isoTime = str.second;
@@ -413,16 +413,22 @@ SaveInfo SavedGame::getSaveInfo(const std::string &file, Language *lang)
 }
 
 /**
- * Loads a saved game's contents from a YAML file.
+ * Loads a saved game's contents from a YAML or binary file.
  * @note Assumes the saved game is blank.
- * @param filename YAML filename.
+ * @param filename Save filename.
  * @param mod Mod for the saved game.
  * @param lang Loaded language.
  */
 void SavedGame::load(const std::string &filename, Mod *mod, Language *lang)
 {
+	auto startTime = std::chrono::steady_clock::now();
 	std::string filepath = Options::getMasterUserFolder() + filename;
-	std::vector<YAML::Node> file = YAML::LoadAll(*CrossPlatform::readFile(filepath));
+	std::vector<YAML::Node> file = BinarySave::loadFile(filepath);
+	if (file.size() < 2)
+	{
+		throw Exception(filename + " is not a save file");
+	}
+	auto readTime = std::chrono::steady_clock::now();
 	// Get brief save info
 	YAML::Node brief = file[0];
 	_time->load(brief["time"]);
@@ -838,18 +844,21 @@ void SavedGame::load(const std::string &filename, Mod *mod, Language *lang)
 	}
 
 	_scriptValues.load(doc, mod->getScriptGlobal());
+
+	auto endTime = std::chrono::steady_clock::now();
+	Log(LOG_INFO) << "Loaded " << filename << ": read " << std::chrono::duration<double, std::milli>(readTime - startTime).count()
+		<< " ms, build " << std::chrono::duration<double, std::milli>(endTime - readTime).count() << " ms";
 }
 
 /**
- * Saves a saved game's contents to a YAML file.
- * @param filename YAML filename.
+ * Builds both documents of a save.
+ * @param brief Brief game info used in the saves list.
+ * @param node Full game data.
+ * @param mod Mod for the saved game.
  */
-void SavedGame::save(const std::string &filename, Mod *mod) const
+void SavedGame::saveDocuments(YAML::Node &brief, YAML::Node &node, Mod *mod) const
 {
-	YAML::Emitter out;
-
 	// Saves the brief game info used in the saves list
-	YAML::Node brief;
 	brief["name"] = _name;
 	brief["version"] = OPENXCOM_FTA_VERSION_SHORT;
 	brief["engine"] = OPENXCOM_VERSION_ENGINE;
@@ -880,10 +889,7 @@ void SavedGame::save(const std::string &filename, Mod *mod) const
 		brief["ironman"] = _ironman;
 	if (_ftaGame)
 		brief["ftaGame"] = _ftaGame;
-	out << brief;
 	// Saves the full game data to the save
-	out << YAML::BeginDoc;
-	YAML::Node node;
 	node["difficulty"] = (int)_difficulty;
 	node["end"] = (int)_end;
 	node["monthsPassed"] = _monthsPassed;
@@ -1043,15 +1049,58 @@ void SavedGame::save(const std::string &filename, Mod *mod) const
 		node["battleGame"] = _battleGame->save();
 	}
 	_scriptValues.save(node, mod->getScriptGlobal());
+}
 
-	out << node;
-
+/**
+ * Saves a saved game's contents to a YAML or binary file (see Options::saveBinary).
+ * @param filename Save filename.
+ * @param mod Mod for the saved game.
+ */
+void SavedGame::save(const std::string &filename, Mod *mod) const
+{
+	auto startTime = std::chrono::steady_clock::now();
+	YAML::Node brief, node;
+	saveDocuments(brief, node, mod);
+	auto buildTime = std::chrono::steady_clock::now();
 
 	std::string filepath = Options::getMasterUserFolder() + filename;
-	if (!CrossPlatform::writeFile(filepath, out.c_str()))
+	bool saved;
+	size_t size;
+	if (Options::saveBinary)
+	{
+		std::vector<unsigned char> data;
+		BinarySave::write(data, brief, node);
+		size = data.size();
+		saved = CrossPlatform::writeFile(filepath, data);
+	}
+	else
+	{
+		std::string data = BinarySave::writeYaml(brief, node);
+		size = data.size();
+		saved = CrossPlatform::writeFile(filepath, data);
+	}
+	if (!saved)
 	{
 		throw Exception("Failed to save " + filepath);
 	}
+
+	auto endTime = std::chrono::steady_clock::now();
+	Log(LOG_INFO) << "Saved " << filename << (Options::saveBinary ? " (binary, " : " (YAML, ") << size << " bytes): build "
+		<< std::chrono::duration<double, std::milli>(buildTime - startTime).count() << " ms, write "
+		<< std::chrono::duration<double, std::milli>(endTime - buildTime).count() << " ms";
+}
+
+/**
+ * Takes a copy of the saved game's contents that can be written
+ * to a file later on another thread.
+ * @param mod Mod for the saved game.
+ * @return Encoded save documents.
+ */
+BinarySave::Snapshot SavedGame::snapshot(Mod *mod) const
+{
+	YAML::Node brief, node;
+	saveDocuments(brief, node, mod);
+	return BinarySave::snapshot(brief, node);
 }
 
 /**
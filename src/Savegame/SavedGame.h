@@ -31,6 +31,7 @@
 #include "../Mod/RuleBaseFacility.h"
 #include "../Mod/RuleCraft.h"
 #include "../Engine/Script.h"
+#include "../Engine/BinarySave.h"
 
 namespace OpenXcom
 {
@@ -47,6 +48,7 @@ class Waypoint;
 class SavedBattleGame;
 class TextList;
 class Language;
+class SaveIndex;
 class RuleResearch;
 class ResearchProject;
 class Soldier;
@@ -196,7 +198,9 @@ private:
 	bool _alienContainmentChecked;
 	ScriptValues<SavedGame> _scriptValues;
 
-	static SaveInfo getSaveInfo(const std::string &file, Language *lang);
+	static SaveInfo getSaveInfo(const std::string &file, const YAML::Node &doc, time_t timestamp, Language *lang);
+	/// Builds both documents of a save.
+	void saveDocuments(YAML::Node &brief, YAML::Node &node, Mod *mod) const;
 public:
 	static const std::string AUTOSAVE_GEOSCAPE, AUTOSAVE_BATTLESCAPE, QUICKSAVE;
 	/// Creates a new saved game.
@@ -206,11 +210,13 @@ public:
 	/// Sanitizes a mod name in a save.
 	static std::string sanitizeModName(const std::string &name);
 	/// Gets list of saves in the user directory.
-	static std::vector<SaveInfo> getList(Language *lang, bool autoquick);
-	/// Loads a saved game from YAML.
+	static std::vector<SaveInfo> getList(const SaveIndex &index, Language *lang, bool autoquick);
+	/// Loads a saved game from YAML or binary file.
 	void load(const std::string &filename, Mod *mod, Language *lang);
-	/// Saves a saved game to YAML.
+	/// Saves a saved game to YAML or binary file.
 	void save(const std::string &filename, Mod *mod) const;
+	/// Takes a snapshot of the saved game for writing in background.
+	BinarySave::Snapshot snapshot(Mod *mod) const;
 	/// Gets the game name.
 	std::string getName() const;
 	/// Sets the game name.
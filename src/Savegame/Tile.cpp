@@ -32,6 +32,7 @@
 #include "../Battlescape/BattlescapeGame.h"
 #include "../fmath.h"
 #include "SavedBattleGame.h"
+#include "../Battlescape/Pathfinding.h"
 
 namespace OpenXcom
 {
@@ -47,11 +48,30 @@ Tile::SerializationKey Tile::serializationKey =
  4 + 2*4 + 2*4 + 1 + 1 + 1 // total bytes to save one tile
 };
 
+/**
+ * Resets all layers to default values.
+ * @param size Number of tiles on the map.
+ */
+void TileLayers::assign(size_t size)
+{
+	for (int layer = 0; layer < LL_MAX; ++layer)
+	{
+		light[layer].assign(size, 0);
+	}
+	fire.assign(size, 0);
+	smoke.assign(size, 0);
+	obstacle.assign(size, 0);
+	danger.assign(size, 0);
+	terrainLevel.assign(size, 0);
+	visible.assign(size, 0);
+}
+
 /**
  * constructor
  * @param pos Position.
+ * @param save Battle that the tile belongs to, its tile layers need to be already allocated.
  */
-Tile::Tile(Position pos, SavedBattleGame* save): _save(save), _pos(pos)
+Tile::Tile(Position pos, SavedBattleGame* save): _save(save), _layers(&save->getTileLayers()), _index(save->getTileIndex(pos)), _pos(pos)
 {
 	for (int i = 0; i < O_MAX; ++i)
 	{
@@ -60,10 +80,6 @@ Tile::Tile(Position pos, SavedBattleGame* save): _save(save), _pos(pos)
 		_mapData->SetID[i] = -1;
 		_objectsCache[i].currentFrame = 0;
 	}
-	for (int layer = 0; layer < LL_MAX; layer++)
-	{
-		_light[layer] = 0;
-	}
 	for (int i = 0; i < O_MAX; ++i)
 	{
 		_objectsCache[i].discovered = 0;
@@ -91,8 +107,8 @@ void Tile::load(const YAML::Node &node)
 		_mapData->ID[i] = node["mapDataID"][i].as<int>(_mapData->ID[i]);
 		_mapData->SetID[i] = node["mapDataSetID"][i].as<int>(_mapData->SetID[i]);
 	}
-	_fire = node["fire"].as<int>(_fire);
-	_smoke = node["smoke"].as<int>(_smoke);
+	_layers->fire[_index] = node["fire"].as<int>(_layers->fire[_index]);
+	_layers->smoke[_index] = node["smoke"].as<int>(_layers->smoke[_index]);
 	if (node["discovered"])
 	{
 		for (int i = 0; i < 3; i++)
@@ -109,7 +125,7 @@ void Tile::load(const YAML::Node &node)
 	{
 		_objectsCache[2].currentFrame = 7;
 	}
-	if (_fire || _smoke)
+	if (_layers->fire[_index] || _layers->smoke[_index])
 	{
 		_animationOffset = RNG::seedless(0, 3);
 	}
@@ -131,8 +147,8 @@ void Tile::loadBinary(Uint8 *buffer, Tile::SerializationKey& serKey)
 	_mapData->SetID[2] = unserializeInt(&buffer, serKey._mapDataSetID);
 	_mapData->SetID[3] = unserializeInt(&buffer, serKey._mapDataSetID);
 
-	_smoke = unserializeInt(&buffer, serKey._smoke);
-	_fire = unserializeInt(&buffer, serKey._fire);
+	_layers->smoke[_index] = unserializeInt(&buffer, serKey._smoke);
+	_layers->fire[_index] = unserializeInt(&buffer, serKey._fire);
 
 	Uint8 boolFields = unserializeInt(&buffer, serKey.boolFields);
 	_objectsCache[O_WESTWALL].discovered = (boolFields & 1) ? 1 : 0;
@@ -140,7 +156,7 @@ void Tile::loadBinary(Uint8 *buffer, Tile::SerializationKey& serKey)
 	_objectsCache[O_FLOOR].discovered = (boolFields & 4) ? 1 : 0;
 	_objectsCache[O_WESTWALL].currentFrame = (boolFields & 8) ? 7 : 0;
 	_objectsCache[O_NORTHWALL].currentFrame = (boolFields & 0x10) ? 7 : 0;
-	if (_fire || _smoke)
+	if (_layers->fire[_index] || _layers->smoke[_index])
 	{
 		_animationOffset = RNG::seedless(0, 3);
 	}
@@ -160,10 +176,10 @@ YAML::Node Tile::save() const
 		node["mapDataID"].push_back(_mapData->ID[i]);
 		node["mapDataSetID"].push_back(_mapData->SetID[i]);
 	}
-	if (_smoke)
-		node["smoke"] = _smoke;
-	if (_fire)
-		node["fire"] = _fire;
+	if (_layers->smoke[_index])
+		node["smoke"] = _layers->smoke[_index];
+	if (_layers->fire[_index])
+		node["fire"] = _layers->fire[_index];
 	if (_objectsCache[O_FLOOR].discovered || _objectsCache[O_WESTWALL].discovered || _objectsCache[O_NORTHWALL].discovered)
 	{
 		throw Exception("Obsolete code");
@@ -198,8 +214,8 @@ void Tile::saveBinary(Uint8** buffer) const
 	serializeInt(buffer, serializationKey._mapDataSetID, _mapData->SetID[2]);
 	serializeInt(buffer, serializationKey._mapDataSetID, _mapData->SetID[3]);
 
-	serializeInt(buffer, serializationKey._smoke, _smoke);
-	serializeInt(buffer, serializationKey._fire, _fire);
+	serializeInt(buffer, serializationKey._smoke, _layers->smoke[_index]);
+	serializeInt(buffer, serializationKey._fire, _layers->fire[_index]);
 
 	Uint8 boolFields = (_objectsCache[O_WESTWALL].discovered?1:0) + (_objectsCache[O_NORTHWALL].discovered?2:0) + (_objectsCache[O_FLOOR].discovered?4:0);
 	boolFields |= isUfoDoorOpen(O_WESTWALL) ? 8 : 0; // west
@@ -246,9 +262,38 @@ void Tile::setMapData(MapData *dat, int mapDataID, int mapDataSetID, TilePart pa
 		{
 			_cache.bigWall = 0;
 		}
-		_cache.terrainLevel = level;
+		_layers->terrainLevel[_index] = level;
 	}
 	updateSprite(part);
+	terrainChanged();
+}
+
+/**
+ * Tells battle that terrain of this tile has changed,
+ * so the terrain voxels and cached move costs around it are recalculated.
+ */
+void Tile::terrainChanged()
+{
+	if (_save)
+	{
+		_save->updateTerrainVoxels(this);
+	}
+	if (_save && _save->getPathfinding())
+	{
+		_save->getPathfinding()->invalidateTerrain(_pos);
+	}
+}
+
+/**
+ * Tells pathfinding that fire or smoke of this tile has changed,
+ * as they add penalties to move costs.
+ */
+void Tile::hazardChanged()
+{
+	if (_save && _save->getPathfinding())
+	{
+		_save->getPathfinding()->invalidateReachable();
+	}
 }
 
 /**
@@ -270,7 +315,7 @@ void Tile::getMapData(int *mapDataID, int *mapDataSetID, TilePart part) const
  */
 bool Tile::isVoid() const
 {
-	return _objects[0] == 0 && _objects[1] == 0 && _objects[2] == 0 && _objects[3] == 0 && _smoke == 0 && _inventory.empty();
+	return _objects[0] == 0 && _objects[1] == 0 && _objects[2] == 0 && _objects[3] == 0 && _layers->smoke[_index] == 0 && _inventory.empty();
 }
 
 /**
@@ -377,6 +422,7 @@ int Tile::openDoor(TilePart part, BattleUnit *unit, BattleActionType reserve, bo
 			return 4;
 		_objectsCache[part].currentFrame = 1; // start opening door
 		updateSprite((TilePart)part);
+		terrainChanged();
 		return 1;
 	}
 	if (_objectsCache[part].isUfoDoor && _objectsCache[part].currentFrame != 7) // ufo door != part 7 - door is still opening
@@ -399,6 +445,10 @@ int Tile::closeUfoDoor()
 			updateSprite((TilePart)part);
 		}
 	}
+	if (retval)
+	{
+		terrainChanged();
+	}
 
 	return retval;
 }
@@ -438,7 +488,7 @@ bool Tile::isDiscovered(TilePart part) const
  */
 void Tile::resetLight(LightLayers layer)
 {
-	_light[layer] = 0;
+	_layers->light[layer][_index] = 0;
 }
 
 /**
@@ -449,7 +499,7 @@ void Tile::resetLightMulti(LightLayers layer)
 {
 	for (int l = layer; l < LL_MAX; l++)
 	{
-		_light[l] = 0;
+		_layers->light[l][_index] = 0;
 	}
 }
 
@@ -460,8 +510,8 @@ void Tile::resetLightMulti(LightLayers layer)
  */
 void Tile::addLight(int light, LightLayers layer)
 {
-	if (_light[layer] < light)
-		_light[layer] = light;
+	if (_layers->light[layer][_index] < light)
+		_layers->light[layer][_index] = light;
 }
 
 /**
@@ -471,7 +521,7 @@ void Tile::addLight(int light, LightLayers layer)
  */
 int Tile::getLight(LightLayers layer) const
 {
-	return _light[layer];
+	return _layers->light[layer][_index];
 }
 
 int Tile::getLightMulti(LightLayers layer) const
@@ -480,8 +530,8 @@ int Tile::getLightMulti(LightLayers layer) const
 
 	for (int l = layer; l >= 0; --l)
 	{
-		if (_light[l] > light)
-			light = _light[l];
+		if (_layers->light[l][_index] > light)
+			light = _layers->light[l][_index];
 	}
 
 	return light;
@@ -499,8 +549,8 @@ int Tile::getShade() const
 
 	for (int layer = 0; layer < LL_MAX; layer++)
 	{
-		if (_light[layer] > light)
-			light = _light[layer];
+		if (_layers->light[layer][_index] > light)
+			light = _layers->light[layer][_index];
 	}
 
 	return std::max(0, 15 - light);
@@ -658,12 +708,13 @@ void Tile::ignite(int power)
 		}
 		if (RNG::percent(power) && getFuel())
 		{
-			if (_fire == 0)
+			if (_layers->fire[_index] == 0)
 			{
-				_smoke = 15 - Clamp(getFlammability() / 10, 1, 12);
+				_layers->smoke[_index] = 15 - Clamp(getFlammability() / 10, 1, 12);
 				_overlaps = 1;
-				_fire = getFuel() + 1;
+				_layers->fire[_index] = getFuel() + 1;
 				_animationOffset = RNG::generate(0,3);
+				hazardChanged();
 			}
 		}
 	}
@@ -673,10 +724,13 @@ void Tile::ignite(int power)
  * Animate the tile. This means to advance the current frame for every object.
  * Ufo doors are a bit special, they animated only when triggered.
  * When ufo doors are on frame 0(closed) or frame 7(open) they are not animated further.
+ * @return True if the sprite of any part changed.
  */
-void Tile::animate()
+bool Tile::animate()
 {
 	int newframe;
+	bool doorMoved = false;
+	bool spriteChanged = false;
 	for (int i = O_FLOOR; i < O_MAX; ++i)
 	{
 		if (_objects[i])
@@ -695,9 +749,18 @@ void Tile::animate()
 				newframe = 0;
 			}
 			_objectsCache[i].currentFrame = newframe;
+			doorMoved = doorMoved || _objectsCache[i].isUfoDoor;
 		}
+		const Uint8 *oldSprite = _currentSurface[i].getBuffer();
 		updateSprite((TilePart)i);
+		spriteChanged = spriteChanged || oldSprite != _currentSurface[i].getBuffer();
+	}
+	// ufo door move cost depends on its animation frame
+	if (doorMoved)
+	{
+		terrainChanged();
 	}
+	return spriteChanged;
 }
 
 /**
@@ -741,8 +804,9 @@ BattleUnit *Tile::getOverlappingUnit(const SavedBattleGame *saveBattleGame, Tile
  */
 void Tile::setFire(int fire)
 {
-	_fire = Clamp(fire, 0, 255);
+	_layers->fire[_index] = Clamp(fire, 0, 255);
 	_animationOffset = RNG::generate(0,3);
+	hazardChanged();
 }
 
 /**
@@ -751,7 +815,7 @@ void Tile::setFire(int fire)
  */
 int Tile::getFire() const
 {
-	return _fire;
+	return _layers->fire[_index];
 }
 
 /**
@@ -760,18 +824,19 @@ int Tile::getFire() const
  */
 void Tile::addSmoke(int smoke)
 {
-	if (_fire == 0)
+	if (_layers->fire[_index] == 0)
 	{
 		if (_overlaps == 0)
 		{
-			_smoke = Clamp(_smoke + smoke, 1, 15);
+			_layers->smoke[_index] = Clamp(_layers->smoke[_index] + smoke, 1, 15);
 		}
 		else
 		{
-			_smoke += smoke;
+			_layers->smoke[_index] += smoke;
 		}
 		_animationOffset = RNG::generate(0,3);
 		addOverlap();
+		hazardChanged();
 	}
 }
 
@@ -781,8 +846,9 @@ void Tile::addSmoke(int smoke)
  */
 void Tile::setSmoke(int smoke)
 {
-	_smoke = Clamp(smoke, 0, 255);
+	_layers->smoke[_index] = Clamp(smoke, 0, 255);
 	_animationOffset = RNG::generate(0,3);
+	hazardChanged();
 }
 
 
@@ -792,7 +858,7 @@ void Tile::setSmoke(int smoke)
  */
 int Tile::getSmoke() const
 {
-	return _smoke;
+	return _layers->smoke[_index];
 }
 
 /**
@@ -909,17 +975,18 @@ static inline void applyEnvi(BattleUnit* unit, int smoke, int fire, bool smokeDa
 void Tile::prepareNewTurn(bool smokeDamage)
 {
 	// we've received new smoke in this turn, but we're not on fire, average out the smoke.
-	if ( _overlaps != 0 && _smoke != 0 && _fire == 0)
+	if ( _overlaps != 0 && _layers->smoke[_index] != 0 && _layers->fire[_index] == 0)
 	{
-		_smoke = Clamp((_smoke / _overlaps) - 1, 0, 15);
+		_layers->smoke[_index] = Clamp((_layers->smoke[_index] / _overlaps) - 1, 0, 15);
+		hazardChanged();
 	}
 	// if we still have smoke/fire
-	if (_smoke)
+	if (_layers->smoke[_index])
 	{
-		applyEnvi(_unit, _smoke, _fire, smokeDamage);
+		applyEnvi(_unit, _layers->smoke[_index], _layers->fire[_index], smokeDamage);
 		for (std::vector<BattleItem*>::iterator i = _inventory.begin(); i != _inventory.end(); ++i)
 		{
-			applyEnvi((*i)->getUnit(), _smoke, _fire, smokeDamage);
+			applyEnvi((*i)->getUnit(), _layers->smoke[_index], _layers->fire[_index], smokeDamage);
 		}
 	}
 	_overlaps = 0;
@@ -959,7 +1026,7 @@ int Tile::getMarkerColor() const
  */
 void Tile::setVisible(int visibility)
 {
-	_visible += visibility;
+	_layers->visible[_index] += visibility;
 }
 
 /**
@@ -968,7 +1035,7 @@ void Tile::setVisible(int visibility)
  */
 int Tile::getVisible() const
 {
-	return _visible;
+	return _layers->visible[_index];
 }
 
 /**
@@ -1048,7 +1115,7 @@ void Tile::addOverlap()
  */
 void Tile::setDangerous(bool danger)
 {
-	_cache.danger = danger;
+	_layers->danger[_index] = danger;
 }
 
 /**
@@ -1057,7 +1124,7 @@ void Tile::setDangerous(bool danger)
  */
 bool Tile::getDangerous() const
 {
-	return _cache.danger;
+	return _layers->danger[_index] != 0;
 }
 
 /**
@@ -1065,7 +1132,7 @@ bool Tile::getDangerous() const
  */
 void Tile::setObstacle(int part)
 {
-	_obstacle |= (1 << part);
+	_layers->obstacle[_index] |= (1 << part);
 }
 
 /**
@@ -1073,7 +1140,7 @@ void Tile::setObstacle(int part)
  */
 void Tile::resetObstacle(void)
 {
-	_obstacle = 0;
+	_layers->obstacle[_index] = 0;
 }
 
 
@@ -37,6 +37,24 @@ class ScriptParserBase;
 
 enum LightLayers : Uint8 { LL_AMBIENT, LL_FIRE, LL_ITEMS, LL_UNITS, LL_MAX };
 
+/**
+ * Frequently used fields of all tiles of a map, stored as separate arrays indexed by tile index.
+ * Sweeps over the whole map (smoke and fire spreading, lighting) then touch only the data they need.
+ */
+struct TileLayers
+{
+	std::vector<Uint8> light[LL_MAX];
+	std::vector<Uint8> fire;
+	std::vector<Uint8> smoke;
+	std::vector<Uint8> obstacle;
+	std::vector<Uint8> danger;
+	std::vector<Sint8> terrainLevel;
+	std::vector<Sint16> visible;
+
+	/// Resets all layers to default values for a given number of tiles.
+	void assign(size_t size);
+};
+
 enum TileUnitOverlapping : int
 {
 	/// Any unit overlapping tile will be returned
@@ -99,14 +117,14 @@ public:
 	 */
 	struct TileCache
 	{
-		Sint8 terrainLevel = 0;
 		Uint8 isNoFloor:1;
 		Uint8 bigWall:1;
-		Uint8 danger:1;
 	};
 
 protected:
 	SavedBattleGame* _save;
+	TileLayers* _layers;
+	int _index;
 	MapData *_objects[O_MAX];
 	BattleUnit *_unit = nullptr;
 	std::vector<BattleItem *> _inventory;
@@ -115,20 +133,19 @@ protected:
 	TileObjectCache _objectsCache[O_MAX] = { };
 	TileCache _cache = { };
 	Position _pos;
-	Uint8 _light[LL_MAX];
-	Uint8 _fire = 0;
-	Uint8 _smoke = 0;
 	Uint8 _markerColor = 0;
 	Uint8 _animationOffset = 0;
-	Uint8 _obstacle = 0;
 	Uint8 _explosiveType = 0;
 	Sint16 _explosive = 0;
-	Sint16 _visible = 0;
 	Sint16 _TUMarker = -1;
 	Sint16 _EnergyMarker = -1;
 	Sint8 _preview = -1;
 	Uint8 _overlaps = 0;
 
+	/// Tells pathfinding that terrain of this tile has changed.
+	void terrainChanged();
+	/// Tells pathfinding that fire or smoke of this tile has changed.
+	void hazardChanged();
 
 public:
 	/// Creates a tile.
@@ -206,7 +223,7 @@ public:
 	 */
 	int getTerrainLevel() const
 	{
-		return _cache.terrainLevel;
+		return _layers->terrainLevel[_index];
 	}
 
 	/**
@@ -303,7 +320,7 @@ public:
 	/// Get explosive power of this tile.
 	int getExplosiveType() const;
 	/// Animated the tile parts.
-	void animate();
+	bool animate();
 	/// Update cached value of sprite.
 	void updateSprite(TilePart part);
 	/// Get object sprites.
@@ -397,12 +414,12 @@ public:
 	/// gets single obstacle flag.
 	bool getObstacle(int part) const
 	{
-		return _obstacle & (1 << part);
+		return _layers->obstacle[_index] & (1 << part);
 	}
 	/// does the tile have obstacle flag set for at least one part?
 	bool isObstacle(void) const
 	{
-		return _obstacle != 0;
+		return _layers->obstacle[_index] != 0;
 	}
 	/// reset obstacle flags
 	void resetObstacle(void);